@@ -0,0 +1,31 @@
+#include "algorithm.hxx"
+#include <algorithm>
+#include <utility>
+
+namespace cube {
+
+Algorithm::Algorithm(std::vector<Move> moves)
+    : m_moves(std::move(moves)), m_cubie(CubieCube::solved()) {
+  for (auto m : m_moves) {
+    m_cubie.multiply(move_cube(m));
+  }
+  m_kernel =
+      ShuffleKernel::from_permutation(FaceletPermutation::from_cubie(m_cubie));
+}
+
+std::optional<Algorithm> Algorithm::parse(std::string_view text) {
+  auto moves = parse_moves(text);
+  if (!moves) {
+    return {};
+  }
+  return Algorithm(std::move(*moves));
+}
+
+Algorithm Algorithm::inverse() const {
+  std::vector<Move> moves(m_moves.rbegin(), m_moves.rend());
+  std::transform(moves.begin(), moves.end(), moves.begin(),
+                 [](Move m) { return cube::inverse(m); });
+  return Algorithm(std::move(moves));
+}
+
+} // namespace cube
@@ -0,0 +1,42 @@
+#ifndef ALGORITHM_HXX
+#define ALGORITHM_HXX
+#include "cube.hxx"
+#include "facelet.hxx"
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace cube {
+
+/* NOTE: A move sequence compiled once into what it does to the cube, both
+ as a cubie state to multiply with and as a shuffle kernel for the facelets.
+ Applying it costs a single move however long the sequence is, which is what
+ trainers and benchmarks replaying the same algorithms over and over want. */
+class Algorithm {
+public:
+  explicit Algorithm(std::vector<Move> moves);
+
+  // Parses singmaster notation, see parse_moves().
+  static std::optional<Algorithm> parse(std::string_view text);
+
+  const std::vector<Move> &moves() const { return m_moves; }
+
+  // The state the sequence leaves the solved cube in.
+  const CubieCube &cubie() const { return m_cubie; }
+  const ShuffleKernel &kernel() const { return m_kernel; }
+
+  // The moves in reverse order, each turned the other way.
+  Algorithm inverse() const;
+
+  void apply(CubieCube &cc) const { cc.multiply(m_cubie); }
+  void apply(FaceletCube &fc) const { fc.apply(m_kernel); }
+
+private:
+  std::vector<Move> m_moves;
+  CubieCube m_cubie;
+  ShuffleKernel m_kernel;
+};
+
+} // namespace cube
+
+#endif // ALGORITHM_HXX
@@ -0,0 +1,98 @@
+#include "batch.hxx"
+#include "facelet.hxx"
+#include "thread_pool.hxx"
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using cube::CubieCube;
+
+namespace solver {
+
+// Lines per pool task.
+static constexpr size_t SOLVE_BATCH = 16;
+
+static const std::string ERROR_PREFIX = "error: ";
+
+BatchSolver::BatchSolver(SolveMode mode, unsigned thread_count)
+    : m_thread_count(thread_count) {
+  if (m_thread_count == 0) {
+    m_thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  if (mode == SolveMode::OPTIMAL) {
+    m_optimal.emplace(1);
+  } else {
+    m_fast.emplace();
+  }
+}
+
+std::string BatchSolver::solve_line(std::string_view line) const {
+  auto end = line.find_last_not_of(" \t\r");
+  line = line.substr(0, end == std::string_view::npos ? 0 : end + 1);
+
+  CubieCube cc;
+  if (auto fc = cube::FaceletCube::parse(line)) {
+    auto state = fc->to_cubie();
+    if (!state) {
+      return ERROR_PREFIX + "unreachable facelets";
+    }
+    cc = *state;
+  } else if (auto moves = cube::parse_moves(line)) {
+    cc = CubieCube::solved();
+    cc.apply(*moves);
+  } else {
+    return ERROR_PREFIX + "not a cube state";
+  }
+
+  if (m_optimal) {
+    return cube::to_string(m_optimal->solve(cc));
+  }
+  if (auto solution = m_fast->solve(cc)) {
+    return cube::to_string(*solution);
+  }
+  return ERROR_PREFIX + "no solution found";
+}
+
+uint64_t BatchSolver::solve(std::istream &in, std::ostream &out) const {
+  ThreadPool pool(m_thread_count);
+  const size_t round_size = 4 * m_thread_count * SOLVE_BATCH;
+  std::vector<std::string> lines;
+  std::vector<std::string> batches;
+  std::atomic<uint64_t> failed = 0;
+
+  while (in) {
+    lines.clear();
+    std::string line;
+    while (lines.size() < round_size && std::getline(in, line)) {
+      lines.push_back(std::move(line));
+    }
+
+    batches.assign((lines.size() + SOLVE_BATCH - 1) / SOLVE_BATCH, {});
+    for (size_t b = 0; b < batches.size(); b++) {
+      pool.submit([&, b]() {
+        size_t end = std::min((b + 1) * SOLVE_BATCH, lines.size());
+        for (size_t i = b * SOLVE_BATCH; i < end; i++) {
+          auto result = solve_line(lines[i]);
+          if (result.starts_with(ERROR_PREFIX)) {
+            failed++;
+          }
+          batches[b] += result;
+          batches[b] += '\n';
+        }
+      });
+    }
+    pool.wait();
+
+    for (const auto &batch : batches) {
+      out << batch;
+    }
+    if (!out) {
+      throw std::runtime_error("Could not write the solutions!");
+    }
+  }
+  return failed;
+}
+
+} // namespace solver
@@ -0,0 +1,43 @@
+#ifndef BATCH_HXX
+#define BATCH_HXX
+#include "cube.hxx"
+#include "optimal.hxx"
+#include "solver.hxx"
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace solver {
+
+/* NOTE: Solves cube states one per line. A line is either the 54 facelets
+ FaceletCube::parse accepts or a move sequence that scrambles a solved cube,
+ like the output of rubiks_scrambles. Every line gives one line of output,
+ the solution or "error: " and why there is none, so the outputs line up
+ with the inputs. Streams are read in rounds of a few batches per thread,
+ which keeps memory bounded whatever the input size. */
+class BatchSolver {
+public:
+  // Solves on thread_count threads, 0 uses every core. Every thread runs a
+  // single search, the optimal solver does not split them up further.
+  explicit BatchSolver(SolveMode mode = SolveMode::FAST,
+                       unsigned thread_count = 0);
+
+  std::string solve_line(std::string_view line) const;
+
+  // Solves every line of in and writes the results to out in input order.
+  // Returns the number of lines that could not be solved, throws
+  // std::runtime_error when the output stream fails.
+  uint64_t solve(std::istream &in, std::ostream &out) const;
+
+private:
+  unsigned m_thread_count;
+  std::optional<TwoPhaseSolver> m_fast;
+  std::optional<OptimalSolver> m_optimal;
+};
+
+} // namespace solver
+
+#endif // BATCH_HXX
@@ -0,0 +1,259 @@
+#include "bidirectional.hxx"
+#include "canonical.hxx"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+
+using cube::CubieCube;
+using cube::Move;
+using cube::MOVE_COUNT;
+using cube::TWIST_COUNT;
+
+namespace solver {
+
+// States at each distance from solved in the half turn metric.
+static constexpr std::array<size_t, MAX_PERIMETER_DEPTH + 1> DISTANCE_COUNTS =
+    {1, 18, 243, 3240, 43239, 574908, 7618438};
+
+static constexpr uint64_t EMPTY = ~uint64_t{0};
+static constexpr int DISTANCE_SHIFT = 27;
+static constexpr int MOVE_SHIFT = DISTANCE_SHIFT + 3;
+static constexpr uint64_t CORNER_MASK = (uint64_t{1} << DISTANCE_SHIFT) - 1;
+
+static uint64_t mix(uint64_t x) {
+  // The splitmix64 finalizer.
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+  return x ^ (x >> 31);
+}
+
+static uint64_t pack_edges(const EdgeLocations &edges) {
+  uint64_t packed = 0;
+  for (int i = 0; i < cube::EDGE_COUNT; i++) {
+    packed |= static_cast<uint64_t>(edges[i]) << (5 * i);
+  }
+  return packed;
+}
+
+size_t PerimeterSet::slot(uint64_t corners, uint64_t edges) const {
+  return mix(edges ^ mix(corners)) & m_mask;
+}
+
+PerimeterSet::PerimeterSet(int depth) : m_depth(depth) {
+  if (depth < 0 || depth > MAX_PERIMETER_DEPTH) {
+    throw std::invalid_argument("Unsupported perimeter depth!");
+  }
+  size_t count = 0;
+  for (int d = 0; d <= depth; d++) {
+    count += DISTANCE_COUNTS[d];
+  }
+  // At most half full, so probes stay short.
+  m_entries.assign(std::bit_ceil(2 * count), {EMPTY, 0});
+  m_mask = m_entries.size() - 1;
+
+  std::vector<CubieCube> frontier = {CubieCube::solved()};
+  insert(frontier[0], 0, Move::U1);
+  for (int d = 1; d <= depth; d++) {
+    std::vector<CubieCube> next;
+    next.reserve(DISTANCE_COUNTS[d]);
+    for (const auto &cc : frontier) {
+      for (int i = 0; i < MOVE_COUNT; i++) {
+        auto m = static_cast<Move>(i);
+        auto moved = cc;
+        moved.apply(m);
+        if (insert(moved, d, m)) {
+          next.push_back(moved);
+        }
+      }
+    }
+    frontier = std::move(next);
+  }
+}
+
+bool PerimeterSet::insert(const CubieCube &cc, int distance, Move last) {
+  uint64_t corners = static_cast<uint64_t>(cube::get_corners(cc)) *
+                         TWIST_COUNT +
+                     cube::get_twist(cc);
+  uint64_t edges = pack_edges(edge_locations(cc));
+  for (size_t i = slot(corners, edges);; i = (i + 1) & m_mask) {
+    auto &entry = m_entries[i];
+    if (entry.edges == EMPTY) {
+      entry.edges = edges;
+      entry.corners = corners |
+                      static_cast<uint64_t>(distance) << DISTANCE_SHIFT |
+                      static_cast<uint64_t>(last) << MOVE_SHIFT;
+      return true;
+    }
+    if (entry.edges == edges && (entry.corners & CORNER_MASK) == corners) {
+      return false;
+    }
+  }
+}
+
+std::optional<PerimeterSet::Found>
+PerimeterSet::find(int corner_perm, int twist,
+                   const EdgeLocations &edges) const {
+  uint64_t corners = static_cast<uint64_t>(corner_perm) * TWIST_COUNT + twist;
+  uint64_t packed = pack_edges(edges);
+  for (size_t i = slot(corners, packed);; i = (i + 1) & m_mask) {
+    const auto &entry = m_entries[i];
+    if (entry.edges == EMPTY) {
+      return {};
+    }
+    if (entry.edges == packed && (entry.corners & CORNER_MASK) == corners) {
+      return Found{static_cast<int>((entry.corners >> DISTANCE_SHIFT) & 7),
+                   static_cast<Move>(entry.corners >> MOVE_SHIFT)};
+    }
+  }
+}
+
+// Nodes at most this many moves above the perimeter skip the table.
+static constexpr int TRANSPOSITION_MIN_TOGO = 2;
+
+// Key of a forward search node in the transposition table.
+static uint64_t node_key(int corner_perm, int twist, const EdgeLocations &edges,
+                         uint8_t canonical_state) {
+  uint64_t corners = static_cast<uint64_t>(corner_perm) * TWIST_COUNT + twist;
+  return mix(mix(corners | uint64_t{canonical_state} << DISTANCE_SHIFT) ^
+             pack_edges(edges));
+}
+
+namespace {
+
+struct PerimeterSearch {
+  const cube::MoveTables &mt;
+  const OptimalTables &pt;
+  const PerimeterSet &perimeter;
+  TranspositionTable *transpositions = nullptr;
+  std::array<Move, MAX_OPTIMAL_DEPTH> path{};
+  BidirectionalSolver::Stats stats{};
+
+  int bound(int corner_perm, int twist, const EdgeLocations &edges) const {
+    int b = pt.corners.get(pt.corner_index(corner_perm, twist));
+    b = std::max<int>(b, pt.edges_low.get(edge_group_index(edges, 0)));
+    return std::max<int>(
+        b, pt.edges_high.get(edge_group_index(edges, EDGE_GROUP_SIZE)));
+  }
+
+  // Nodes within the perimeter depth of the end are looked up instead of
+  // searched, one that is not in the set is further away than that.
+  bool search(int corner_perm, int twist, const EdgeLocations &edges,
+              int depth, int togo) {
+    stats.nodes++;
+    if (togo <= perimeter.depth()) {
+      auto found = perimeter.find(corner_perm, twist, edges);
+      return found && found->distance <= togo;
+    }
+    auto state = depth > 0 ? cube::canonical_state_after(path[depth - 1])
+                           : cube::CANONICAL_START;
+    // Nodes right above the perimeter only probe the set, the table would
+    // cost more than it saves there.
+    bool transposable =
+        transpositions && togo > perimeter.depth() + TRANSPOSITION_MIN_TOGO;
+    uint64_t key = 0;
+    if (transposable) {
+      // Only the same number of moves to go searches the same subtree.
+      key = node_key(corner_perm, twist, edges, state);
+      auto entry = transpositions->probe(key);
+      if (entry && static_cast<int>(entry->value) == togo) {
+        stats.transposition_hits++;
+        return false;
+      }
+    }
+    for (auto moves = cube::canonical_moves(state); moves != 0;
+         moves &= moves - 1) {
+      int i = std::countr_zero(moves);
+      auto m = static_cast<Move>(i);
+      int ncorner_perm = mt.corners[corner_perm * MOVE_COUNT + i];
+      int ntwist = mt.twist[twist * MOVE_COUNT + i];
+      if (pt.corners.get(pt.corner_index(ncorner_perm, ntwist)) >= togo) {
+        continue;
+      }
+      auto nedges = edges;
+      move_edge_locations(nedges, m);
+      if (pt.edges_low.get(edge_group_index(nedges, 0)) >= togo ||
+          pt.edges_high.get(edge_group_index(nedges, EDGE_GROUP_SIZE)) >=
+              togo) {
+        continue;
+      }
+      path[depth] = m;
+      if (search(ncorner_perm, ntwist, nedges, depth + 1, togo - 1)) {
+        return true;
+      }
+    }
+    if (transposable) {
+      transpositions->store(key, {static_cast<uint32_t>(togo),
+                                  static_cast<uint8_t>(togo)});
+    }
+    return false;
+  }
+};
+
+} // namespace
+
+BidirectionalSolver::BidirectionalSolver(int perimeter_depth,
+                                         size_t transposition_bytes)
+    : m_moves(cube::MoveTables::instance()),
+      m_tables(OptimalTables::instance()), m_perimeter(perimeter_depth) {
+  if (transposition_bytes > 0) {
+    m_transpositions.emplace(transposition_bytes);
+  }
+}
+
+std::optional<std::vector<Move>>
+BidirectionalSolver::solve(const CubieCube &cc, int max_length,
+                           Stats *stats) const {
+  if (!cc.is_valid()) {
+    throw std::invalid_argument("Cannot solve an unreachable cube state!");
+  }
+
+  PerimeterSearch search{m_moves, m_tables, m_perimeter,
+                         m_transpositions ? &*m_transpositions : nullptr};
+  int corner_perm = cube::get_corners(cc);
+  int twist = cube::get_twist(cc);
+  auto edges = edge_locations(cc);
+
+  std::vector<Move> solution;
+  int depth = std::max(search.bound(corner_perm, twist, edges), 0);
+  if (!m_perimeter.find(corner_perm, twist, edges)) {
+    // Everything closer would have been in the set.
+    depth = std::max(depth, m_perimeter.depth() + 1);
+    for (;; depth++) {
+      if (depth > max_length) {
+        if (stats) {
+          *stats = search.stats;
+        }
+        return {};
+      }
+      if (search.search(corner_perm, twist, edges, 0, depth)) {
+        break;
+      }
+    }
+    solution.assign(search.path.begin(),
+                    search.path.begin() + depth - m_perimeter.depth());
+  }
+  if (stats) {
+    *stats = search.stats;
+  }
+
+  // The rest is walked back through the set.
+  auto reached = cc;
+  reached.apply(solution);
+  while (auto found = m_perimeter.find(cube::get_corners(reached),
+                                       cube::get_twist(reached),
+                                       edge_locations(reached))) {
+    if (found->distance == 0) {
+      break;
+    }
+    auto m = cube::inverse(found->last);
+    solution.push_back(m);
+    reached.apply(m);
+  }
+  if (static_cast<int>(solution.size()) > max_length) {
+    return {};
+  }
+  return solution;
+}
+
+} // namespace solver
@@ -0,0 +1,98 @@
+#ifndef BIDIRECTIONAL_HXX
+#define BIDIRECTIONAL_HXX
+#include "coord.hxx"
+#include "cube.hxx"
+#include "optimal.hxx"
+#include "transposition.hxx"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace solver {
+
+constexpr int DEFAULT_PERIMETER_DEPTH = 5;
+constexpr int MAX_PERIMETER_DEPTH = 6;
+constexpr size_t DEFAULT_TRANSPOSITION_BYTES = size_t{16} << 20;
+
+/* NOTE: Every state at most depth moves from solved, packed into 16 bytes:
+ the corner coordinates next to the edge locations, 5 bits for each edge,
+ along with the distance and the last move of a shortest way there. They
+ live in an open addressing hash set sized for the known number of states,
+ some 620k for depth 5 and 8.2M for depth 6. */
+class PerimeterSet {
+public:
+  struct Found {
+    int distance;
+    // Undoing this move gets one step closer to solved.
+    cube::Move last;
+  };
+
+  explicit PerimeterSet(int depth);
+
+  int depth() const { return m_depth; }
+
+  std::optional<Found> find(int corner_perm, int twist,
+                            const EdgeLocations &edges) const;
+
+private:
+  struct Entry {
+    uint64_t edges;
+    // corner_perm * TWIST_COUNT + twist, the distance and the last move.
+    uint64_t corners;
+  };
+
+  bool insert(const cube::CubieCube &cc, int distance, cube::Move last);
+  size_t slot(uint64_t corners, uint64_t edges) const;
+
+  int m_depth;
+  std::vector<Entry> m_entries;
+  size_t m_mask;
+};
+
+/* NOTE: Meet in the middle for short optimal solutions, as a perimeter
+ search: the backward half is the PerimeterSet around solved, the forward
+ half is the IDA* of the optimal solver that stops perimeter depth moves
+ early and looks the node up instead. This cuts off the bottom levels of
+ the search where most nodes are, the last moves come from walking the
+ set back to solved. Positions up to about 14 moves take at most tens of
+ milliseconds.
+
+ Canonical sequences still reach some states along several paths, like
+ R2 L2 U2 and L2 R2 U2 after commuting. The forward search remembers the
+ nodes it searched in vain in a TranspositionTable, keyed by the cube
+ state, the automaton state and the moves to go, and skips them when they
+ come up again. Whether such a node leads anywhere depends on nothing else,
+ so the table is kept across solves and shared by threads: solving a
+ position again, or one a move away as hints do, skips most of the failed
+ iterations. Nodes close to the perimeter are left out, their subtrees are
+ cheaper than the lookups. */
+class BidirectionalSolver {
+public:
+  struct Stats {
+    uint64_t nodes = 0;
+    // Nodes skipped because the table knew them.
+    uint64_t transposition_hits = 0;
+  };
+
+  // A transposition_bytes of 0 turns the table off.
+  explicit BidirectionalSolver(
+      int perimeter_depth = DEFAULT_PERIMETER_DEPTH,
+      size_t transposition_bytes = DEFAULT_TRANSPOSITION_BYTES);
+
+  // An optimal solution, or nothing if it takes more than max_length moves.
+  // Throws std::invalid_argument for unreachable cubes.
+  std::optional<std::vector<cube::Move>>
+  solve(const cube::CubieCube &cc, int max_length = MAX_OPTIMAL_DEPTH,
+        Stats *stats = nullptr) const;
+
+private:
+  const cube::MoveTables &m_moves;
+  const OptimalTables &m_tables;
+  PerimeterSet m_perimeter;
+  // Thread safe, written by const solves.
+  mutable std::optional<TranspositionTable> m_transpositions;
+};
+
+} // namespace solver
+
+#endif // BIDIRECTIONAL_HXX
@@ -0,0 +1,77 @@
+#ifndef CANONICAL_HXX
+#define CANONICAL_HXX
+#include "cube.hxx"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace cube {
+
+/* NOTE: A finite automaton accepting the canonical move sequences: no face
+ is turned twice in a row and of two opposite faces turned one after the
+ other, the U, R or F one comes first, so U D is allowed but D U is not.
+ Every other sequence has a canonical one at most as long reaching the same
+ state, so searches only walk this automaton. Its states are the start and
+ the face turned last, which brings the branching factor down from 18 to
+ about 13.35. */
+constexpr int CANONICAL_STATE_COUNT = static_cast<int>(Face::COUNT) + 1;
+constexpr uint8_t CANONICAL_START = static_cast<uint8_t>(Face::COUNT);
+constexpr uint8_t CANONICAL_REJECT = 0xff;
+
+struct CanonicalAutomaton {
+  // Bit m is set for every move m allowed in the state.
+  std::array<uint32_t, CANONICAL_STATE_COUNT> moves;
+  std::array<std::array<uint8_t, MOVE_COUNT>, CANONICAL_STATE_COUNT> next;
+};
+
+namespace detail {
+
+constexpr CanonicalAutomaton make_canonical_automaton() {
+  CanonicalAutomaton automaton{};
+  for (int state = 0; state < CANONICAL_STATE_COUNT; state++) {
+    for (int m = 0; m < MOVE_COUNT; m++) {
+      int f = static_cast<int>(face_of(static_cast<Move>(m)));
+      bool allowed =
+          state == CANONICAL_START || (f != state && f + 3 != state);
+      if (allowed) {
+        automaton.moves[state] |= uint32_t{1} << m;
+      }
+      automaton.next[state][m] = allowed ? f : CANONICAL_REJECT;
+    }
+  }
+  return automaton;
+}
+
+} // namespace detail
+
+inline constexpr CanonicalAutomaton CANONICAL =
+    detail::make_canonical_automaton();
+
+// The moves allowed after the given ones, the start state for none.
+constexpr uint32_t canonical_moves(uint8_t state) {
+  return CANONICAL.moves[state];
+}
+
+constexpr uint8_t canonical_next(uint8_t state, Move m) {
+  return CANONICAL.next[state][static_cast<int>(m)];
+}
+
+// The state after the last move of a canonical sequence.
+constexpr uint8_t canonical_state_after(Move last) {
+  return static_cast<uint8_t>(face_of(last));
+}
+
+constexpr bool is_canonical(const std::vector<Move> &moves) {
+  uint8_t state = CANONICAL_START;
+  for (auto m : moves) {
+    state = canonical_next(state, m);
+    if (state == CANONICAL_REJECT) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace cube
+
+#endif // CANONICAL_HXX
@@ -0,0 +1,159 @@
+#include "coord.hxx"
+#include "lehmer.hxx"
+#include <array>
+
+namespace cube {
+
+static constexpr int binomial(int n, int k) {
+  if (k < 0 || k > n) {
+    return 0;
+  }
+  int result = 1;
+  for (int i = 1; i <= k; i++) {
+    result = result * (n - k + i) / i;
+  }
+  return result;
+}
+
+int get_twist(const CubieCube &cc) {
+  int twist = 0;
+  for (int i = 0; i < CORNER_COUNT - 1; i++) {
+    twist = 3 * twist + cc.corner_ori(i);
+  }
+  return twist;
+}
+
+void set_twist(CubieCube &cc, int twist) {
+  int sum = 0;
+  for (int i = CORNER_COUNT - 2; i >= 0; i--) {
+    cc.set_corner(i, cc.corner_perm(i), twist % 3);
+    sum += twist % 3;
+    twist /= 3;
+  }
+  cc.set_corner(CORNER_COUNT - 1, cc.corner_perm(CORNER_COUNT - 1),
+                (3 - sum % 3) % 3);
+}
+
+int get_flip(const CubieCube &cc) {
+  int flip = 0;
+  for (int i = 0; i < EDGE_COUNT - 1; i++) {
+    flip = 2 * flip + cc.edge_ori(i);
+  }
+  return flip;
+}
+
+void set_flip(CubieCube &cc, int flip) {
+  int sum = 0;
+  for (int i = EDGE_COUNT - 2; i >= 0; i--) {
+    cc.set_edge(i, cc.edge_perm(i), flip % 2);
+    sum += flip % 2;
+    flip /= 2;
+  }
+  cc.set_edge(EDGE_COUNT - 1, cc.edge_perm(EDGE_COUNT - 1), sum % 2);
+}
+
+int get_slice_sorted(const CubieCube &cc) {
+  std::array<uint8_t, 4> order;
+  int a = 0, x = 0;
+  for (int j = EDGE_COUNT - 1; j >= 0; j--) {
+    int e = cc.edge_perm(j);
+    if (e >= FR) {
+      a += binomial(EDGE_COUNT - 1 - j, x + 1);
+      order[3 - x] = e - FR;
+      x++;
+    }
+  }
+  return SLICE_PERM_COUNT * a + rank_permutation(order);
+}
+
+void set_slice_sorted(CubieCube &cc, int slice_sorted) {
+  auto order = unrank_permutation<4>(slice_sorted % SLICE_PERM_COUNT);
+  int a = slice_sorted / SLICE_PERM_COUNT;
+
+  std::array<int, EDGE_COUNT> ep;
+  ep.fill(-1);
+  int x = 4;
+  for (int j = 0; j < EDGE_COUNT && x > 0; j++) {
+    int c = binomial(EDGE_COUNT - 1 - j, x);
+    if (a - c >= 0) {
+      ep[j] = FR + order[4 - x];
+      a -= c;
+      x--;
+    }
+  }
+  int other = UR;
+  for (int j = 0; j < EDGE_COUNT; j++) {
+    if (ep[j] < 0) {
+      ep[j] = other++;
+    }
+    cc.set_edge(j, ep[j], cc.edge_ori(j));
+  }
+}
+
+int get_corners(const CubieCube &cc) {
+  std::array<uint8_t, CORNER_COUNT> perm;
+  for (int i = 0; i < CORNER_COUNT; i++) {
+    perm[i] = cc.corner_perm(i);
+  }
+  return rank_permutation(perm);
+}
+
+void set_corners(CubieCube &cc, int corners) {
+  auto perm = unrank_permutation<CORNER_COUNT>(corners);
+  for (int i = 0; i < CORNER_COUNT; i++) {
+    cc.set_corner(i, perm[i], cc.corner_ori(i));
+  }
+}
+
+int get_ud_edges(const CubieCube &cc) {
+  std::array<uint8_t, 8> perm;
+  for (int i = 0; i < 8; i++) {
+    perm[i] = cc.edge_perm(i);
+  }
+  return rank_permutation(perm);
+}
+
+void set_ud_edges(CubieCube &cc, int ud_edges) {
+  auto perm = unrank_permutation<8>(ud_edges);
+  for (int i = 0; i < 8; i++) {
+    cc.set_edge(i, perm[i], cc.edge_ori(i));
+  }
+  for (int i = 8; i < EDGE_COUNT; i++) {
+    cc.set_edge(i, i, cc.edge_ori(i));
+  }
+}
+
+template <typename Get, typename Set>
+static std::vector<uint16_t> build_move_table(int count, Get get, Set set,
+                                              bool phase2_only = false) {
+  std::vector<uint16_t> table(static_cast<size_t>(count) * MOVE_COUNT, 0);
+  for (int i = 0; i < count; i++) {
+    auto cc = CubieCube::solved();
+    set(cc, i);
+    for (int m = 0; m < MOVE_COUNT; m++) {
+      if (phase2_only && !is_phase2_move(static_cast<Move>(m))) {
+        continue;
+      }
+      auto moved = cc;
+      moved.apply(static_cast<Move>(m));
+      table[i * MOVE_COUNT + m] = get(moved);
+    }
+  }
+  return table;
+}
+
+MoveTables::MoveTables()
+    : twist(build_move_table(TWIST_COUNT, get_twist, set_twist)),
+      flip(build_move_table(FLIP_COUNT, get_flip, set_flip)),
+      slice_sorted(build_move_table(SLICE_SORTED_COUNT, get_slice_sorted,
+                                    set_slice_sorted)),
+      corners(build_move_table(CORNERS_COUNT, get_corners, set_corners)),
+      ud_edges(build_move_table(UD_EDGES_COUNT, get_ud_edges, set_ud_edges,
+                                true)) {}
+
+const MoveTables &MoveTables::instance() {
+  static MoveTables tables;
+  return tables;
+}
+
+} // namespace cube
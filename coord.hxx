@@ -0,0 +1,68 @@
+#ifndef COORD_HXX
+#define COORD_HXX
+#include "cube.hxx"
+#include <cstdint>
+#include <vector>
+
+namespace cube {
+
+/* NOTE: Coordinates map one aspect of a CubieCube to a dense integer so that
+ moves can be applied with a single table lookup. All of them are zero on the
+ solved cube. Phase 1 of the two-phase solver works with twist, flip and the
+ unordered slice position, phase 2 with the corner and U/D edge permutations
+ and the order of the slice edges. */
+constexpr int TWIST_COUNT = 2187;        // 3^7
+constexpr int FLIP_COUNT = 2048;         // 2^11
+constexpr int SLICE_COUNT = 495;         // 12 choose 4
+constexpr int SLICE_PERM_COUNT = 24;     // 4!
+constexpr int SLICE_SORTED_COUNT = 11880; // 12! / 8!
+constexpr int CORNERS_COUNT = 40320;     // 8!
+constexpr int UD_EDGES_COUNT = 40320;    // 8!
+
+int get_twist(const CubieCube &cc);
+void set_twist(CubieCube &cc, int twist);
+
+int get_flip(const CubieCube &cc);
+void set_flip(CubieCube &cc, int flip);
+
+// Position and order of the FR, FL, BL and BR edges, slice_sorted / 24 is the
+// phase 1 slice coordinate and slice_sorted % 24 the order of the four edges.
+int get_slice_sorted(const CubieCube &cc);
+void set_slice_sorted(CubieCube &cc, int slice_sorted);
+
+int get_corners(const CubieCube &cc);
+void set_corners(CubieCube &cc, int corners);
+
+// Only meaningful while the slice edges are in the slice, as in phase 2.
+int get_ud_edges(const CubieCube &cc);
+void set_ud_edges(CubieCube &cc, int ud_edges);
+
+// The ten moves that keep a cube inside <U, D, R2, L2, F2, B2>.
+constexpr bool is_phase2_move(Move m) {
+  auto f = face_of(m);
+  return f == Face::U || f == Face::D || power_of(m) == 2;
+}
+
+/* NOTE: Move tables are indexed coord * MOVE_COUNT + move. The U/D edge table
+ is only filled in for phase 2 moves since the other moves take the slice
+ edges out of the slice where the coordinate is undefined. */
+class MoveTables {
+public:
+  static const MoveTables &instance();
+
+  std::vector<uint16_t> twist;
+  std::vector<uint16_t> flip;
+  std::vector<uint16_t> slice_sorted;
+  std::vector<uint16_t> corners;
+  std::vector<uint16_t> ud_edges;
+
+  MoveTables(const MoveTables &other) = delete;
+  MoveTables &operator=(const MoveTables &other) = delete;
+
+private:
+  MoveTables();
+};
+
+} // namespace cube
+
+#endif // COORD_HXX
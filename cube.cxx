@@ -0,0 +1,143 @@
+#include "cube.hxx"
+#include <cctype>
+
+namespace cube {
+
+static const char FACE_NAMES[] = {'U', 'R', 'F', 'D', 'L', 'B'};
+
+void CubieCube::apply(const std::vector<Move> &moves) {
+  for (auto m : moves) {
+    apply(m);
+  }
+}
+
+int CubieCube::corner_parity() const {
+  int parity = 0;
+  for (int i = CORNER_COUNT - 1; i > 0; i--) {
+    for (int j = i - 1; j >= 0; j--) {
+      if (corner_perm(j) > corner_perm(i)) {
+        parity++;
+      }
+    }
+  }
+  return parity % 2;
+}
+
+int CubieCube::edge_parity() const {
+  int parity = 0;
+  for (int i = EDGE_COUNT - 1; i > 0; i--) {
+    for (int j = i - 1; j >= 0; j--) {
+      if (edge_perm(j) > edge_perm(i)) {
+        parity++;
+      }
+    }
+  }
+  return parity % 2;
+}
+
+bool CubieCube::is_valid() const {
+  unsigned seen_corners = 0, seen_edges = 0;
+  int twist = 0, flip = 0;
+
+  for (int i = 0; i < CORNER_COUNT; i++) {
+    if (corner_perm(i) >= CORNER_COUNT || corner_ori(i) > 2) {
+      return false;
+    }
+    seen_corners |= 1u << corner_perm(i);
+    twist += corner_ori(i);
+  }
+  for (int i = 0; i < EDGE_COUNT; i++) {
+    if (edge_perm(i) >= EDGE_COUNT || edge_ori(i) > 1) {
+      return false;
+    }
+    seen_edges |= 1u << edge_perm(i);
+    flip += edge_ori(i);
+  }
+
+  return seen_corners == (1u << CORNER_COUNT) - 1 &&
+         seen_edges == (1u << EDGE_COUNT) - 1 && twist % 3 == 0 &&
+         flip % 2 == 0 && corner_parity() == edge_parity();
+}
+
+std::optional<std::vector<Move>> parse_moves(std::string_view text) {
+  std::vector<Move> moves;
+  size_t i = 0;
+
+  while (i < text.size()) {
+    if (std::isspace(static_cast<unsigned char>(text[i]))) {
+      i++;
+      continue;
+    }
+
+    int face = -1;
+    for (int f = 0; f < static_cast<int>(Face::COUNT); f++) {
+      if (text[i] == FACE_NAMES[f]) {
+        face = f;
+      }
+    }
+    if (face < 0) {
+      return {};
+    }
+    i++;
+
+    int power = 1;
+    if (i < text.size() && text[i] == '2') {
+      power = 2;
+      i++;
+    } else if (i < text.size() && (text[i] == '\'' || text[i] == '3')) {
+      power = 3;
+      i++;
+    }
+
+    if (i < text.size() && !std::isspace(static_cast<unsigned char>(text[i]))) {
+      return {};
+    }
+    moves.push_back(make_move(static_cast<Face>(face), power));
+  }
+
+  return moves;
+}
+
+std::string to_string(Move m) {
+  std::string str(1, FACE_NAMES[static_cast<int>(face_of(m))]);
+  switch (power_of(m)) {
+  case 2:
+    str += '2';
+    break;
+  case 3:
+    str += '\'';
+    break;
+  default:
+    break;
+  }
+  return str;
+}
+
+std::string to_string(const std::vector<Move> &moves) {
+  std::string str;
+  for (auto m : moves) {
+    if (!str.empty()) {
+      str += ' ';
+    }
+    str += to_string(m);
+  }
+  return str;
+}
+
+std::ostream &operator<<(std::ostream &strm, Move m) {
+  return strm << to_string(m);
+}
+
+std::ostream &operator<<(std::ostream &strm, const CubieCube &cc) {
+  strm << "{ corners: ";
+  for (int i = 0; i < CORNER_COUNT; i++) {
+    strm << int(cc.corner_perm(i)) << '/' << int(cc.corner_ori(i)) << ' ';
+  }
+  strm << "edges: ";
+  for (int i = 0; i < EDGE_COUNT; i++) {
+    strm << int(cc.edge_perm(i)) << '/' << int(cc.edge_ori(i)) << ' ';
+  }
+  return strm << "}";
+}
+
+} // namespace cube
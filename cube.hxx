@@ -0,0 +1,218 @@
+#ifndef CUBE_HXX
+#define CUBE_HXX
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cube {
+
+// Cubie naming and numbering follows Kociemba so the move tables and the
+// coordinates built on top of them can be checked against his references.
+enum Corner : uint8_t { URF, UFL, ULB, UBR, DFR, DLF, DBL, DRB, CORNER_COUNT };
+
+enum Edge : uint8_t {
+  UR, UF, UL, UB, DR, DF, DL, DB, FR, FL, BL, BR, EDGE_COUNT
+};
+
+enum struct Face : uint8_t { U, R, F, D, L, B, COUNT };
+
+// The 18 face turns of the half turn metric, ordered face * 3 + power - 1
+// where U1 is a clockwise quarter turn, U2 a half turn and U3 = U'.
+enum struct Move : uint8_t {
+  U1, U2, U3,
+  R1, R2, R3,
+  F1, F2, F3,
+  D1, D2, D3,
+  L1, L2, L3,
+  B1, B2, B3,
+  COUNT
+};
+
+constexpr int MOVE_COUNT = static_cast<int>(Move::COUNT);
+
+constexpr Face face_of(Move m) {
+  return static_cast<Face>(static_cast<uint8_t>(m) / 3);
+}
+
+// Number of clockwise quarter turns, 1 to 3.
+constexpr int power_of(Move m) { return static_cast<uint8_t>(m) % 3 + 1; }
+
+constexpr Move make_move(Face f, int power) {
+  return static_cast<Move>(static_cast<uint8_t>(f) * 3 + (power - 1));
+}
+
+constexpr Move inverse(Move m) { return make_move(face_of(m), 4 - power_of(m)); }
+
+/* NOTE: Every cubie is stored in a single byte, the permutation in the low
+ bits and the orientation above it, so the whole state is 20 bytes. The
+ arrays use the "is replaced by" convention: corners[URF] tells which corner
+ currently sits in the URF slot and how it is twisted. */
+struct CubieCube {
+  static constexpr uint8_t CORNER_PERM_MASK = 0x07;
+  static constexpr uint8_t CORNER_ORI_SHIFT = 3;
+  static constexpr uint8_t EDGE_PERM_MASK = 0x0f;
+  static constexpr uint8_t EDGE_ORI_SHIFT = 4;
+
+  std::array<uint8_t, CORNER_COUNT> corners;
+  std::array<uint8_t, EDGE_COUNT> edges;
+
+  static constexpr CubieCube solved() {
+    CubieCube cc{};
+    for (uint8_t i = 0; i < CORNER_COUNT; i++) {
+      cc.corners[i] = i;
+    }
+    for (uint8_t i = 0; i < EDGE_COUNT; i++) {
+      cc.edges[i] = i;
+    }
+    return cc;
+  }
+
+  static constexpr CubieCube from_arrays(const std::array<uint8_t, 8> &cp,
+                                         const std::array<uint8_t, 8> &co,
+                                         const std::array<uint8_t, 12> &ep,
+                                         const std::array<uint8_t, 12> &eo) {
+    CubieCube cc{};
+    for (int i = 0; i < CORNER_COUNT; i++) {
+      cc.corners[i] = cp[i] | (co[i] << CORNER_ORI_SHIFT);
+    }
+    for (int i = 0; i < EDGE_COUNT; i++) {
+      cc.edges[i] = ep[i] | (eo[i] << EDGE_ORI_SHIFT);
+    }
+    return cc;
+  }
+
+  constexpr uint8_t corner_perm(int i) const {
+    return corners[i] & CORNER_PERM_MASK;
+  }
+  constexpr uint8_t corner_ori(int i) const {
+    return corners[i] >> CORNER_ORI_SHIFT;
+  }
+  constexpr uint8_t edge_perm(int i) const { return edges[i] & EDGE_PERM_MASK; }
+  constexpr uint8_t edge_ori(int i) const { return edges[i] >> EDGE_ORI_SHIFT; }
+
+  constexpr void set_corner(int i, uint8_t perm, uint8_t ori) {
+    corners[i] = perm | (ori << CORNER_ORI_SHIFT);
+  }
+  constexpr void set_edge(int i, uint8_t perm, uint8_t ori) {
+    edges[i] = perm | (ori << EDGE_ORI_SHIFT);
+  }
+
+  // this = this * b, i.e. b is applied after the current state.
+  constexpr void multiply(const CubieCube &b) {
+    CubieCube a = *this;
+    for (int i = 0; i < CORNER_COUNT; i++) {
+      // Adding the twists in place only overflows the orientation bits when
+      // their sum reaches 3, which is exactly when the byte reaches 24.
+      uint8_t src = b.corners[i];
+      uint8_t moved = a.corners[src & CORNER_PERM_MASK] + (src & ~CORNER_PERM_MASK);
+      corners[i] = moved >= 24 ? moved - 24 : moved;
+    }
+    for (int i = 0; i < EDGE_COUNT; i++) {
+      uint8_t src = b.edges[i];
+      edges[i] = a.edges[src & EDGE_PERM_MASK] ^ (src & ~EDGE_PERM_MASK);
+    }
+  }
+
+  constexpr CubieCube inverse() const {
+    CubieCube inv{};
+    for (int i = 0; i < CORNER_COUNT; i++) {
+      uint8_t ori = corner_ori(i);
+      inv.set_corner(corner_perm(i), i, ori == 0 ? 0 : 3 - ori);
+    }
+    for (int i = 0; i < EDGE_COUNT; i++) {
+      inv.set_edge(edge_perm(i), i, edge_ori(i));
+    }
+    return inv;
+  }
+
+  inline void apply(Move m);
+  void apply(const std::vector<Move> &moves);
+
+  constexpr bool is_solved() const { return *this == solved(); }
+
+  // Checks that the cubies form a permutation and that the twist, flip and
+  // parity constraints of a reachable state hold.
+  bool is_valid() const;
+  int corner_parity() const;
+  int edge_parity() const;
+
+  constexpr bool operator==(const CubieCube &other) const = default;
+};
+
+namespace detail {
+
+// clang-format off
+constexpr CubieCube BASIC_MOVES[static_cast<int>(Face::COUNT)] = {
+    // U
+    CubieCube::from_arrays({UBR, URF, UFL, ULB, DFR, DLF, DBL, DRB},
+                           {0, 0, 0, 0, 0, 0, 0, 0},
+                           {UB, UR, UF, UL, DR, DF, DL, DB, FR, FL, BL, BR},
+                           {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}),
+    // R
+    CubieCube::from_arrays({DFR, UFL, ULB, URF, DRB, DLF, DBL, UBR},
+                           {2, 0, 0, 1, 1, 0, 0, 2},
+                           {FR, UF, UL, UB, BR, DF, DL, DB, DR, FL, BL, UR},
+                           {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}),
+    // F
+    CubieCube::from_arrays({UFL, DLF, ULB, UBR, URF, DFR, DBL, DRB},
+                           {1, 2, 0, 0, 2, 1, 0, 0},
+                           {UR, FL, UL, UB, DR, FR, DL, DB, UF, DF, BL, BR},
+                           {0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0}),
+    // D
+    CubieCube::from_arrays({URF, UFL, ULB, UBR, DLF, DBL, DRB, DFR},
+                           {0, 0, 0, 0, 0, 0, 0, 0},
+                           {UR, UF, UL, UB, DF, DL, DB, DR, FR, FL, BL, BR},
+                           {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}),
+    // L
+    CubieCube::from_arrays({URF, ULB, DBL, UBR, DFR, UFL, DLF, DRB},
+                           {0, 1, 2, 0, 0, 2, 1, 0},
+                           {UR, UF, BL, UB, DR, DF, FL, DB, FR, UL, DL, BR},
+                           {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}),
+    // B
+    CubieCube::from_arrays({URF, UFL, UBR, DRB, DFR, DLF, ULB, DBL},
+                           {0, 0, 1, 2, 0, 0, 2, 1},
+                           {UR, UF, UL, BR, DR, DF, DL, BL, FR, FL, UB, DB},
+                           {0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1}),
+};
+// clang-format on
+
+constexpr std::array<CubieCube, MOVE_COUNT> make_move_cubes() {
+  std::array<CubieCube, MOVE_COUNT> table{};
+  for (int f = 0; f < static_cast<int>(Face::COUNT); f++) {
+    CubieCube cc = CubieCube::solved();
+    for (int power = 1; power <= 3; power++) {
+      cc.multiply(BASIC_MOVES[f]);
+      table[f * 3 + power - 1] = cc;
+    }
+  }
+  return table;
+}
+
+} // namespace detail
+
+// The effect of every move on the solved cube, generated at compile time.
+inline constexpr std::array<CubieCube, MOVE_COUNT> MOVE_CUBES =
+    detail::make_move_cubes();
+
+constexpr const CubieCube &move_cube(Move m) {
+  return MOVE_CUBES[static_cast<int>(m)];
+}
+
+inline void CubieCube::apply(Move m) { multiply(move_cube(m)); }
+
+// Parses singmaster notation such as "R U R' U2". Returns nothing when the
+// text contains anything else than face turns separated by whitespace.
+std::optional<std::vector<Move>> parse_moves(std::string_view text);
+std::string to_string(Move m);
+std::string to_string(const std::vector<Move> &moves);
+
+std::ostream &operator<<(std::ostream &strm, Move m);
+std::ostream &operator<<(std::ostream &strm, const CubieCube &cc);
+
+} // namespace cube
+
+#endif // CUBE_HXX
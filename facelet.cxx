@@ -0,0 +1,159 @@
+#include "facelet.hxx"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace cube {
+
+static const char FACE_CHARS[] = "URFDLB";
+
+FaceletCube FaceletCube::from_cubie(const CubieCube &cc) {
+  FaceletCube fc = solved();
+  for (int i = 0; i < CORNER_COUNT; i++) {
+    int ori = cc.corner_ori(i);
+    for (int k = 0; k < 3; k++) {
+      fc.facelets[CORNER_FACELETS[i][(k + ori) % 3]] =
+          static_cast<uint8_t>(CORNER_COLORS[cc.corner_perm(i)][k]);
+    }
+  }
+  for (int i = 0; i < EDGE_COUNT; i++) {
+    int ori = cc.edge_ori(i);
+    for (int k = 0; k < 2; k++) {
+      fc.facelets[EDGE_FACELETS[i][(k + ori) % 2]] =
+          static_cast<uint8_t>(EDGE_COLORS[cc.edge_perm(i)][k]);
+    }
+  }
+  return fc;
+}
+
+std::optional<FaceletCube> FaceletCube::parse(std::string_view text) {
+  if (text.size() != FACELET_COUNT) {
+    return {};
+  }
+
+  std::array<int, 256> face_of_char;
+  face_of_char.fill(-1);
+  for (int face = 0; face < static_cast<int>(Face::COUNT); face++) {
+    auto center = static_cast<unsigned char>(text[face * 9 + 4]);
+    if (face_of_char[center] >= 0) {
+      return {};
+    }
+    face_of_char[center] = face;
+  }
+
+  FaceletCube fc{};
+  std::array<int, static_cast<int>(Face::COUNT)> counts = {0};
+  for (int f = 0; f < FACELET_COUNT; f++) {
+    int face = face_of_char[static_cast<unsigned char>(text[f])];
+    if (face < 0 || ++counts[face] > 9) {
+      return {};
+    }
+    fc.facelets[f] = face;
+  }
+  return fc;
+}
+
+std::optional<CubieCube> FaceletCube::to_cubie() const {
+  CubieCube cc{};
+  auto color = [&](int facelet) { return at(facelet); };
+
+  for (int i = 0; i < CORNER_COUNT; i++) {
+    int ori = 0;
+    while (ori < 3 && color(CORNER_FACELETS[i][ori]) != Face::U &&
+           color(CORNER_FACELETS[i][ori]) != Face::D) {
+      ori++;
+    }
+    if (ori == 3) {
+      return {};
+    }
+    auto col1 = color(CORNER_FACELETS[i][(ori + 1) % 3]);
+    auto col2 = color(CORNER_FACELETS[i][(ori + 2) % 3]);
+    int perm = 0;
+    while (perm < CORNER_COUNT && (CORNER_COLORS[perm][1] != col1 ||
+                                   CORNER_COLORS[perm][2] != col2)) {
+      perm++;
+    }
+    if (perm == CORNER_COUNT) {
+      return {};
+    }
+    cc.set_corner(i, perm, ori);
+  }
+
+  for (int i = 0; i < EDGE_COUNT; i++) {
+    auto col0 = color(EDGE_FACELETS[i][0]);
+    auto col1 = color(EDGE_FACELETS[i][1]);
+    int perm = 0;
+    for (; perm < EDGE_COUNT; perm++) {
+      if (EDGE_COLORS[perm][0] == col0 && EDGE_COLORS[perm][1] == col1) {
+        cc.set_edge(i, perm, 0);
+        break;
+      }
+      if (EDGE_COLORS[perm][0] == col1 && EDGE_COLORS[perm][1] == col0) {
+        cc.set_edge(i, perm, 1);
+        break;
+      }
+    }
+    if (perm == EDGE_COUNT) {
+      return {};
+    }
+  }
+
+  if (!cc.is_valid()) {
+    return {};
+  }
+  return cc;
+}
+
+void FaceletCube::apply(Move m) { apply(MOVE_KERNELS[static_cast<int>(m)]); }
+
+void FaceletCube::apply(const ShuffleKernel &kernel) {
+#if defined(__AVX2__)
+  auto lanes = facelets.data();
+  __m256i low = _mm256_setzero_si256();
+  __m256i high = _mm256_setzero_si256();
+  for (int in = 0; in < FACELET_LANE_COUNT; in++) {
+    auto src = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i *>(lanes + in * 16)));
+    auto ctrl_low = _mm256_load_si256(
+        reinterpret_cast<const __m256i *>(kernel.control[in][0]));
+    auto ctrl_high = _mm256_load_si256(
+        reinterpret_cast<const __m256i *>(kernel.control[in][2]));
+    low = _mm256_or_si256(low, _mm256_shuffle_epi8(src, ctrl_low));
+    high = _mm256_or_si256(high, _mm256_shuffle_epi8(src, ctrl_high));
+  }
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), low);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lanes + 32), high);
+#elif defined(__SSSE3__)
+  auto lanes = facelets.data();
+  __m128i src[FACELET_LANE_COUNT];
+  for (int in = 0; in < FACELET_LANE_COUNT; in++) {
+    src[in] = _mm_load_si128(reinterpret_cast<const __m128i *>(lanes + in * 16));
+  }
+  for (int out = 0; out < FACELET_LANE_COUNT; out++) {
+    __m128i acc = _mm_setzero_si128();
+    for (int in = 0; in < FACELET_LANE_COUNT; in++) {
+      auto ctrl = _mm_load_si128(
+          reinterpret_cast<const __m128i *>(kernel.control[in][out]));
+      acc = _mm_or_si128(acc, _mm_shuffle_epi8(src[in], ctrl));
+    }
+    _mm_store_si128(reinterpret_cast<__m128i *>(lanes + out * 16), acc);
+  }
+#else
+  auto old = facelets;
+  for (int f = 0; f < FACELET_COUNT; f++) {
+    facelets[f] = old[kernel.permutation.source[f]];
+  }
+#endif
+}
+
+std::string FaceletCube::to_string() const {
+  std::string str(FACELET_COUNT, ' ');
+  for (int f = 0; f < FACELET_COUNT; f++) {
+    str[f] = FACE_CHARS[facelets[f]];
+  }
+  return str;
+}
+
+} // namespace cube
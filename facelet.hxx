@@ -0,0 +1,214 @@
+#ifndef FACELET_HXX
+#define FACELET_HXX
+#include "cube.hxx"
+#include "layer.hxx"
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace cube {
+
+constexpr int FACELET_COUNT = 54;
+// Facelets are padded to a whole number of 16 byte lanes for the shuffle
+// kernel, the padding always stays zero.
+constexpr int FACELET_LANE_COUNT = 4;
+constexpr int FACELET_PADDED_COUNT = FACELET_LANE_COUNT * 16;
+
+// Facelet numbering is face by face in U, R, F, D, L, B order, each face read
+// row by row as seen when looking straight at it, the same layout Kociemba's
+// solvers use for their 54 character cube strings.
+// clang-format off
+constexpr uint8_t CORNER_FACELETS[CORNER_COUNT][3] = {
+    {8, 9, 20},   // URF: U9 R1 F3
+    {6, 18, 38},  // UFL: U7 F1 L3
+    {0, 36, 47},  // ULB: U1 L1 B3
+    {2, 45, 11},  // UBR: U3 B1 R3
+    {29, 26, 15}, // DFR: D3 F9 R7
+    {27, 44, 24}, // DLF: D1 L9 F7
+    {33, 53, 42}, // DBL: D7 B9 L7
+    {35, 17, 51}, // DRB: D9 R9 B7
+};
+
+constexpr uint8_t EDGE_FACELETS[EDGE_COUNT][2] = {
+    {5, 10},  {7, 19},  {3, 37},  {1, 46},  // UR UF UL UB
+    {32, 16}, {28, 25}, {30, 43}, {34, 52}, // DR DF DL DB
+    {23, 12}, {21, 41}, {50, 39}, {48, 14}, // FR FL BL BR
+};
+
+constexpr Face CORNER_COLORS[CORNER_COUNT][3] = {
+    {Face::U, Face::R, Face::F}, {Face::U, Face::F, Face::L},
+    {Face::U, Face::L, Face::B}, {Face::U, Face::B, Face::R},
+    {Face::D, Face::F, Face::R}, {Face::D, Face::L, Face::F},
+    {Face::D, Face::B, Face::L}, {Face::D, Face::R, Face::B},
+};
+
+constexpr Face EDGE_COLORS[EDGE_COUNT][2] = {
+    {Face::U, Face::R}, {Face::U, Face::F}, {Face::U, Face::L},
+    {Face::U, Face::B}, {Face::D, Face::R}, {Face::D, Face::F},
+    {Face::D, Face::L}, {Face::D, Face::B}, {Face::F, Face::R},
+    {Face::F, Face::L}, {Face::B, Face::L}, {Face::B, Face::R},
+};
+// clang-format on
+
+// A rearrangement of the stickers: after applying it facelet f holds what
+// was at source[f] before.
+struct FaceletPermutation {
+  std::array<uint8_t, FACELET_COUNT> source;
+
+  static constexpr FaceletPermutation identity() {
+    FaceletPermutation p{};
+    for (uint8_t f = 0; f < FACELET_COUNT; f++) {
+      p.source[f] = f;
+    }
+    return p;
+  }
+
+  // The sticker motion of a cubie level state, centers stay where they are.
+  static constexpr FaceletPermutation from_cubie(const CubieCube &cc) {
+    FaceletPermutation p = identity();
+    for (int i = 0; i < CORNER_COUNT; i++) {
+      int ori = cc.corner_ori(i);
+      for (int k = 0; k < 3; k++) {
+        p.source[CORNER_FACELETS[i][(k + ori) % 3]] =
+            CORNER_FACELETS[cc.corner_perm(i)][k];
+      }
+    }
+    for (int i = 0; i < EDGE_COUNT; i++) {
+      int ori = cc.edge_ori(i);
+      for (int k = 0; k < 2; k++) {
+        p.source[EDGE_FACELETS[i][(k + ori) % 2]] =
+            EDGE_FACELETS[cc.edge_perm(i)][k];
+      }
+    }
+    return p;
+  }
+
+  // this = this * b, b moves the stickers after this does.
+  constexpr void multiply(const FaceletPermutation &b) {
+    FaceletPermutation a = *this;
+    for (int f = 0; f < FACELET_COUNT; f++) {
+      source[f] = a.source[b.source[f]];
+    }
+  }
+
+  constexpr bool operator==(const FaceletPermutation &other) const = default;
+};
+
+/* NOTE: pshufb can only pick bytes from within one 16 byte lane, so a
+ permutation of the 64 padded bytes is split into one control per pair of
+ lanes. Output lane o is the OR of shuffling every input lane i with
+ control[i][o], where entries whose source lies in another lane have their
+ high bit set and shuffle in a zero. Keeping the two output lanes of an
+ input lane next to each other lets the AVX2 path load them as one ymm. */
+struct ShuffleKernel {
+  alignas(32) uint8_t control[FACELET_LANE_COUNT][FACELET_LANE_COUNT][16];
+  FaceletPermutation permutation;
+
+  static constexpr ShuffleKernel from_permutation(const FaceletPermutation &p) {
+    ShuffleKernel kernel{};
+    kernel.permutation = p;
+    for (int in = 0; in < FACELET_LANE_COUNT; in++) {
+      for (int out = 0; out < FACELET_LANE_COUNT; out++) {
+        for (int k = 0; k < 16; k++) {
+          int f = out * 16 + k;
+          int src = f < FACELET_COUNT ? p.source[f] : f;
+          kernel.control[in][out][k] = src / 16 == in ? src % 16 : 0x80;
+        }
+      }
+    }
+    return kernel;
+  }
+};
+
+namespace detail {
+
+constexpr std::array<ShuffleKernel, MOVE_COUNT> make_move_kernels() {
+  std::array<ShuffleKernel, MOVE_COUNT> kernels{};
+  for (int m = 0; m < MOVE_COUNT; m++) {
+    kernels[m] = ShuffleKernel::from_permutation(
+        FaceletPermutation::from_cubie(MOVE_CUBES[m]));
+  }
+  return kernels;
+}
+
+// Every layer turn of the 3x3 cube, indexed (face * 3 + depth) * 3 + power
+// - 1 where the face is U, R or F.
+constexpr std::array<ShuffleKernel, 27> make_layer_kernels() {
+  constexpr auto cycles = make_layer_cycles<3>();
+  std::array<ShuffleKernel, 27> kernels{};
+  for (int face = 0; face < 3; face++) {
+    for (int depth = 0; depth < 3; depth++) {
+      for (int power = 1; power <= 3; power++) {
+        // Moving the facelet numbers themselves gives the source of every
+        // facelet.
+        auto p = FaceletPermutation::identity();
+        apply_layer_move<3>(p.source.data(), cycles,
+                            {static_cast<Face>(face),
+                             static_cast<uint16_t>(depth),
+                             static_cast<uint8_t>(power)});
+        kernels[(face * 3 + depth) * 3 + power - 1] =
+            ShuffleKernel::from_permutation(p);
+      }
+    }
+  }
+  return kernels;
+}
+
+} // namespace detail
+
+inline constexpr std::array<ShuffleKernel, MOVE_COUNT> MOVE_KERNELS =
+    detail::make_move_kernels();
+
+inline constexpr std::array<ShuffleKernel, 27> LAYER_KERNELS =
+    detail::make_layer_kernels();
+
+// The kernel of a layer turn, turns of D, L and B are the matching U, R and
+// F layer turned the other way.
+constexpr const ShuffleKernel &layer_kernel(LayerMove m) {
+  int face = static_cast<int>(m.face), depth = m.depth, power = m.power;
+  if (face >= 3) {
+    face -= 3;
+    depth = 2 - depth;
+    power = 4 - power;
+  }
+  return LAYER_KERNELS[(face * 3 + depth) * 3 + power - 1];
+}
+
+// The sticker level view of a cube, one color (the face it belongs to when
+// solved) per byte.
+struct FaceletCube {
+  alignas(32) std::array<uint8_t, FACELET_PADDED_COUNT> facelets;
+
+  static constexpr FaceletCube solved() {
+    FaceletCube fc{};
+    for (int f = 0; f < FACELET_COUNT; f++) {
+      fc.facelets[f] = f / 9;
+    }
+    return fc;
+  }
+
+  static FaceletCube from_cubie(const CubieCube &cc);
+
+  // Parses a 54 character string in facelet order. Any six distinct
+  // characters may be used, the center of each face decides which face its
+  // character stands for. Returns nothing for malformed strings.
+  static std::optional<FaceletCube> parse(std::string_view text);
+
+  // Returns nothing if the stickers do not describe a reachable cube.
+  std::optional<CubieCube> to_cubie() const;
+
+  Face at(int facelet) const { return static_cast<Face>(facelets[facelet]); }
+
+  void apply(Move m);
+  void apply(const ShuffleKernel &kernel);
+
+  std::string to_string() const;
+
+  bool operator==(const FaceletCube &other) const = default;
+};
+
+} // namespace cube
+
+#endif // FACELET_HXX
@@ -128,40 +128,40 @@ void Game::update() {
   //     this->stop();
   //     break;
   //   case ROTATE_1ST_COLUMN_FORWARD:
-  //     m_rcube.rotate_1st_column_forward();
+  //     m_rcube.rotate_column(0, true);
   //     break;
   //   case ROTATE_2ND_COLUMN_FORWARD:
-  //     m_rcube.rotate_2nd_column_forward();
+  //     m_rcube.rotate_column(1, true);
   //     break;
   //   case ROTATE_3RD_COLUMN_FORWARD:
-  //     m_rcube.rotate_3rd_column_forward();
+  //     m_rcube.rotate_column(2, true);
   //     break;
   //   case ROTATE_1ST_COLUMN_BACKWARDS:
-  //     m_rcube.rotate_1st_column_backwards();
+  //     m_rcube.rotate_column(0, false);
   //     break;
   //   case ROTATE_2ND_COLUMN_BACKWARDS:
-  //     m_rcube.rotate_2nd_column_backwards();
+  //     m_rcube.rotate_column(1, false);
   //     break;
   //   case ROTATE_3RD_COLUMN_BACKWARDS:
-  //     m_rcube.rotate_3rd_column_backwards();
+  //     m_rcube.rotate_column(2, false);
   //     break;
   //   case ROTATE_1ST_ROW_FORWARD:
-  //     m_rcube.rotate_1st_row_forward();
+  //     m_rcube.rotate_row(0, true);
   //     break;
   //   case ROTATE_2ND_ROW_FORWARD:
-  //     m_rcube.rotate_2nd_row_forward();
+  //     m_rcube.rotate_row(1, true);
   //     break;
   //   case ROTATE_3RD_ROW_FORWARD:
-  //     m_rcube.rotate_3rd_row_forward();
+  //     m_rcube.rotate_row(2, true);
   //     break;
   //   case ROTATE_1ST_ROW_BACKWARDS:
-  //     m_rcube.rotate_1st_row_backwards();
+  //     m_rcube.rotate_row(0, false);
   //     break;
   //   case ROTATE_2ND_ROW_BACKWARDS:
-  //     m_rcube.rotate_2nd_row_backwards();
+  //     m_rcube.rotate_row(1, false);
   //     break;
   //   case ROTATE_3RD_ROW_BACKWARDS:
-  //     m_rcube.rotate_3rd_row_backwards();
+  //     m_rcube.rotate_row(2, false);
   //     break;
   //   default:
   //     break;
@@ -222,7 +222,7 @@ void Game::update() {
   glFrontFace(GL_CCW);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  m_gfx.draw();
+  m_gfx.draw(m_rcube.size());
 
   ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
@@ -241,56 +241,6 @@ void Game::update() {
   m_last_frame_timepoint = frame_begin_time;
 }
 
-void RubiksCube::rotate_1st_column_forward() {
-  std::cout << "rotate_1st_column_forward" << std::endl;
-}
-
-void RubiksCube::rotate_2nd_column_forward() {
-  std::cout << "rotate_2nd_column_forward" << std::endl;
-}
-
-void RubiksCube::rotate_3rd_column_forward() {
-  std::cout << "rotate_3rd_column_forward" << std::endl;
-}
-
-void RubiksCube::rotate_1st_column_backwards() {
-  std::cout << "rotate_1st_column_backwards" << std::endl;
-}
-
-void RubiksCube::rotate_2nd_column_backwards() {
-  std::cout << "rotate_2nd_column_backwards" << std::endl;
-}
-
-void RubiksCube::rotate_3rd_column_backwards() {
-  std::cout << "rotate_3rd_column_backwards" << std::endl;
-}
-
-void RubiksCube::rotate_1st_row_forward() {
-  std::cout << "rotate_1st_row_forward" << std::endl;
-}
-
-void RubiksCube::rotate_2nd_row_forward() {
-  std::cout << "rotate_2nd_row_forward" << std::endl;
-}
-
-void RubiksCube::rotate_3rd_row_forward() {
-  std::cout << "rotate_3rd_row_forward" << std::endl;
-}
-
-void RubiksCube::rotate_1st_row_backwards() {
-  std::cout << "rotate_1st_row_backwards" << std::endl;
-}
-
-void RubiksCube::rotate_2nd_row_backwards() {
-  std::cout << "rotate_2nd_row_backwards" << std::endl;
-}
-
-void RubiksCube::rotate_3rd_row_backwards() {
-  std::cout << "rotate_3rd_row_backwards" << std::endl;
-}
-
-void RubiksCube::reset() { std::cout << "reset" << std::endl; }
-
 double Game::current_time() const { return m_current_time; }
 
 void Game::change_viewport_size(int width, int height) {
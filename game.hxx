@@ -2,6 +2,7 @@
 #define GAME_HXX
 #include "geom.hxx"
 #include "gfx.hxx"
+#include "rubiks_cube.hxx"
 #include "utility.hxx"
 #include <array>
 #include <chrono>
@@ -13,29 +14,8 @@
 #include <queue>
 #include <string>
 
-class RubiksCube {
-public:
-  using CellID = int;
-  // Returns negative number if not cell was intersected.
-  CellID ray_intersection(geom::Ray ray) const;
-
-  void rotate_1st_column_forward();
-  void rotate_2nd_column_forward();
-  void rotate_3rd_column_forward();
-  void rotate_1st_column_backwards();
-  void rotate_2nd_column_backwards();
-  void rotate_3rd_column_backwards();
-  void rotate_1st_row_forward();
-  void rotate_2nd_row_forward();
-  void rotate_3rd_row_forward();
-  void rotate_1st_row_backwards();
-  void rotate_2nd_row_backwards();
-  void rotate_3rd_row_backwards();
-  void reset();
-
-private:
-  std::array<CellID, 9 * 3> m_cells;
-};
+// Number of layers of the cube the game simulates and renders.
+constexpr int CUBE_SIZE = 3;
 
 class Action {
 public:
@@ -88,7 +68,7 @@ private:
   void init_window_system();
   void init_input_system();
 
-  RubiksCube m_rcube;
+  RubiksCube<CUBE_SIZE> m_rcube;
   uint64_t m_last_time = 0;
   double m_current_time = 0.0;
   uint64_t delta_time = 0;
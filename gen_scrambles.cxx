@@ -0,0 +1,37 @@
+#include "scramble.hxx"
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Writes random state scrambles one per line, to a file or to stdout when
+// the file is "-". The same seed always gives the same scrambles.
+int main(int argc, char **argv) {
+  if (argc < 3 || argc > 5) {
+    std::cerr << "Usage: " << argv[0]
+              << " <count> <seed> [output-file] [thread-count]\n";
+    return 1;
+  }
+
+  uint64_t count = std::stoull(argv[1]);
+  uint64_t seed = std::stoull(argv[2]);
+  std::string path = argc >= 4 ? argv[3] : "-";
+  unsigned thread_count = argc == 5 ? std::stoul(argv[4]) : 0;
+
+  std::ofstream file;
+  if (path != "-") {
+    file.open(path);
+    if (!file) {
+      std::cerr << "Could not open " << path << "\n";
+      return 1;
+    }
+  }
+  std::ostream &out = path == "-" ? std::cout : file;
+
+  try {
+    solver::Scrambler(seed).write(out, 0, count, thread_count);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,56 @@
+#include "tables.hxx"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+static std::string table_file(const std::filesystem::path &directory,
+                              solver::TableKind kind) {
+  return (directory / (std::string(solver::table_name(kind)) + ".prune"))
+      .string();
+}
+
+// Generates every pruning table into a directory so that table generation
+// can run as its own stage ahead of the solvers, or checks the tables that
+// are already there with --verify.
+int main(int argc, char **argv) {
+  bool verify = argc == 3 && std::strcmp(argv[1], "--verify") == 0;
+  if (argc < 2 || argc > 3) {
+    std::cerr << "Usage: " << argv[0] << " <output-directory> [thread-count]\n"
+              << "       " << argv[0] << " --verify <directory>\n";
+    return 1;
+  }
+
+  if (verify) {
+    int failures = 0;
+    for (int k = 0; k < solver::TABLE_KIND_COUNT; k++) {
+      auto kind = static_cast<solver::TableKind>(k);
+      bool ok = solver::verify_table_file(kind, table_file(argv[2], kind));
+      std::cout << solver::table_name(kind) << ": " << (ok ? "ok" : "BAD")
+                << "\n";
+      failures += !ok;
+    }
+    return failures == 0 ? 0 : 1;
+  }
+
+  std::filesystem::path directory = argv[1];
+  unsigned thread_count = argc == 3 ? std::stoul(argv[2]) : 0;
+  std::filesystem::create_directories(directory);
+
+  for (int k = 0; k < solver::TABLE_KIND_COUNT; k++) {
+    auto kind = static_cast<solver::TableKind>(k);
+
+    auto begin = std::chrono::steady_clock::now();
+    solver::generate_table_file(kind, table_file(directory, kind),
+                                thread_count);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - begin;
+
+    std::cout << solver::table_name(kind) << ": "
+              << solver::table_entry_count(kind) << " entries in "
+              << elapsed.count() << "s\n";
+  }
+
+  return 0;
+}
@@ -1,6 +1,7 @@
 #ifndef GEOM_HXX
 #define GEOM_HXX
 #include <array>
+#include <cstdint>
 #include <glm/vec3.hpp>
 #include <optional>
 
@@ -333,45 +333,50 @@ void gfx::GPU::init_cube() {
   cube_mesh.send_index_data(&indices[0], indices.size());
 }
 
-void gfx::Graphics::draw() {
+void gfx::Graphics::draw(int cube_size) {
   // EXPR_LOG(m_main_shader->id());
   auto viewport_size = m_viewport_size.load();
   dglViewport(0, 0, viewport_size.x, viewport_size.y);
   m_gpu.set_aspect_ratio((float)viewport_size.x / (float)viewport_size.y);
   EXPR_LOG((viewport_size.y / viewport_size.x));
   m_main_shader->use();
-  m_gpu.draw();
+  m_gpu.draw(cube_size);
 }
 
-void gfx::GPU::draw() {
+void gfx::GPU::draw(int cube_size) {
 
-  int size = 3;
-  float distance = 25.0f;
+  int size = cube_size;
+  // Pull the camera back for big cubes so that they still fit on screen.
+  float distance = 25.0f * std::max(size, 3) / 3.0f;
   float spacing = 0.90f;
+  float offset = -(size - 1) * spacing / 2.0f;
 
+  glm::mat4 projection = glm::perspective(
+      glm::pi<float>() * 0.25f, m_aspect_ratio, 0.1f, 4.0f * distance);
+  glm::mat4 view = glm::translate(glm::mat4(1.0f),
+                                  glm::vec3(0.0f, 0.0f, -std::abs(distance)));
+  auto time = Game::instance().current_time();
+  view = glm::rotate(view, static_cast<float>(glm::pi<double>() * time),
+                     glm::vec3(0.0f, 1.0f, 0.0f));
+
+  view = glm::rotate(view, static_cast<float>(glm::pi<double>() * time * 0.5),
+                     glm::vec3(1.0f, 0.0f, 0.0f));
+
+  auto is_outer = [size](int i) { return i == 0 || i == size - 1; };
   for (int z = 0; z < size; z++) {
     for (int y = 0; y < size; y++) {
       for (int x = 0; x < size; x++) {
+        // Cubies inside the cube can never be seen.
+        if (!is_outer(x) && !is_outer(y) && !is_outer(z)) {
+          continue;
+        }
         glm::mat4 model = glm::translate(
-            glm::mat4(1.0f), glm::vec3(-2.0 + x * spacing, -2.0 + y * spacing,
-                                       -2.0f + z * spacing));
-
-        glm::mat4 projection = glm::perspective(glm::pi<float>() * 0.25f,
-                                                m_aspect_ratio, 0.1f, 100.f);
-        glm::mat4 view = glm::translate(
-            glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -std::abs(distance)));
-        auto time = Game::instance().current_time();
-        view = glm::rotate(view, static_cast<float>(glm::pi<double>() * time),
-                           glm::vec3(0.0f, 1.0f, 0.0f));
-
-        view = glm::rotate(view,
-                           static_cast<float>(glm::pi<double>() * time * 0.5),
-                           glm::vec3(1.0f, 0.0f, 0.0f));
+            glm::mat4(1.0f), glm::vec3(offset + x * spacing,
+                                       offset + y * spacing,
+                                       offset + z * spacing));
         glm::mat4 mvp = projection * view * model;
         cube_mesh.send_mvp(mvp);
         cube_mesh.draw();
-        for (int n = 0; n < 4; n++) {
-        }
       }
     }
   }
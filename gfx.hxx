@@ -84,7 +84,8 @@ public:
   SimpleMesh cube_mesh;
 
   void init();
-  void draw();
+  // Draws the cubies of a cube_size x cube_size x cube_size cube.
+  void draw(int cube_size);
   void set_aspect_ratio(float value);
 
   GPU(const GPU &other) = delete;
@@ -118,7 +119,7 @@ public:
   static GLuint link_shader_program(Iterator begin, Iterator end);
 
   void init_shaders();
-  void draw();
+  void draw(int cube_size);
   void viewport_size(int width, int height);
   void viewport_size(glm::ivec2 size);
   glm::ivec2 viewport_size() const;
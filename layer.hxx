@@ -0,0 +1,237 @@
+#ifndef LAYER_HXX
+#define LAYER_HXX
+#include "cube.hxx"
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace cube {
+
+/* NOTE: A turn of one layer of an NxN cube, depth 0 being the face itself
+ and depth N - 1 the opposite face. The power counts clockwise quarter turns
+ as seen when looking at the face, so (R, 1, 1) is the inner slice next to R
+ turning like R does. */
+struct LayerMove {
+  Face face;
+  uint16_t depth;
+  uint8_t power;
+
+  constexpr bool operator==(const LayerMove &other) const = default;
+};
+
+constexpr Face opposite(Face f) {
+  return static_cast<Face>((static_cast<int>(f) + 3) % 6);
+}
+
+// The outer layer turn of a face move.
+constexpr LayerMove layer_move(Move m) {
+  return {face_of(m), 0, static_cast<uint8_t>(power_of(m))};
+}
+
+constexpr LayerMove inverse(LayerMove m) {
+  return {m.face, m.depth, static_cast<uint8_t>(4 - m.power)};
+}
+
+// Stickers are numbered like the facelets of the 3x3 cube: face by face in
+// U, R, F, D, L, B order, each face row by row as seen when looking at it.
+template <int N> constexpr int STICKER_COUNT = 6 * N * N;
+
+template <int N>
+using StickerIndex =
+    std::conditional_t<(STICKER_COUNT<N> <= 65536), uint16_t, uint32_t>;
+
+/* NOTE: Every quarter turn of a layer moves its stickers around in cycles of
+ four: one cycle per sticker along the strip of side faces, and for the two
+ outer layers the cycles of the face turning in place. Opposite faces share
+ the strips, (D, d) turns the same stickers as (U, N - 1 - d) the other way.
+ A sticker at cycle[k] moves to cycle[k + 1]. */
+template <int N> struct LayerCycles {
+  using Cycle = std::array<StickerIndex<N>, 4>;
+
+  // Indexed by the U, R or F face and the depth counted from it.
+  std::array<std::array<std::array<Cycle, N>, N>, 3> strips;
+  // Clockwise turn of the stickers of each face, an odd face keeps its
+  // center in place.
+  std::array<std::array<Cycle, N * N / 4>, 6> faces;
+};
+
+namespace detail {
+
+// Sticker centers in doubled coordinates, odd values from -(N - 1) to N - 1
+// inside a face and +-N on the axis the face is facing. x points to R, y to U
+// and z to F.
+struct Point {
+  int x, y, z;
+};
+
+constexpr Point FACE_NORMALS[6] = {{0, 1, 0},  {1, 0, 0},  {0, 0, 1},
+                                   {0, -1, 0}, {-1, 0, 0}, {0, 0, -1}};
+
+constexpr int dot(Point a, Point b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+// Position of a sticker of an n x n cube.
+constexpr Point sticker_position(int n, int sticker) {
+  int face = sticker / (n * n);
+  int row = sticker / n % n, col = sticker % n;
+  int r = (n - 1) - 2 * row, c = -(n - 1) + 2 * col;
+  switch (face) {
+  case 0: // U, B at the top
+    return {c, n, -r};
+  case 1: // R, F on the left
+    return {n, r, -c};
+  case 2: // F
+    return {c, r, n};
+  case 3: // D, F at the top
+    return {c, -n, r};
+  case 4: // L, B on the left
+    return {-n, r, c};
+  default: // B, R on the left
+    return {-c, r, -n};
+  }
+}
+
+constexpr int sticker_at(int n, Point p) {
+  auto index = [n](int face, int r, int c) {
+    return face * n * n + ((n - 1) - r) / 2 * n + (c + (n - 1)) / 2;
+  };
+  if (p.y == n) {
+    return index(0, -p.z, p.x);
+  }
+  if (p.x == n) {
+    return index(1, p.y, -p.z);
+  }
+  if (p.z == n) {
+    return index(2, p.y, p.x);
+  }
+  if (p.y == -n) {
+    return index(3, p.z, p.x);
+  }
+  if (p.x == -n) {
+    return index(4, p.y, p.z);
+  }
+  return index(5, p.y, -p.x);
+}
+
+// Where a point ends up after a clockwise quarter turn around normal n.
+constexpr Point turn_clockwise(Point p, Point n) {
+  // n (n . p) - n x p, a rotation by -90 degrees around n.
+  int d = dot(n, p);
+  return {n.x * d - (n.y * p.z - n.z * p.y), n.y * d - (n.z * p.x - n.x * p.z),
+          n.z * d - (n.x * p.y - n.y * p.x)};
+}
+
+template <int N>
+constexpr typename LayerCycles<N>::Cycle make_cycle(int sticker, Point normal) {
+  typename LayerCycles<N>::Cycle cycle{};
+  auto p = sticker_position(N, sticker);
+  for (int k = 0; k < 4; k++) {
+    cycle[k] = sticker_at(N, p);
+    p = turn_clockwise(p, normal);
+  }
+  return cycle;
+}
+
+template <int N> constexpr LayerCycles<N> make_layer_cycles() {
+  LayerCycles<N> cycles{};
+  for (int axis = 0; axis < 3; axis++) {
+    auto normal = FACE_NORMALS[axis];
+    // Every strip cycle passes the next face exactly once.
+    int side = (axis + 1) % 3;
+    for (int depth = 0; depth < N; depth++) {
+      int k = 0;
+      for (int i = 0; i < N * N; i++) {
+        int sticker = side * N * N + i;
+        if (dot(sticker_position(N, sticker), normal) == (N - 1) - 2 * depth) {
+          cycles.strips[axis][depth][k++] = make_cycle<N>(sticker, normal);
+        }
+      }
+    }
+  }
+  for (int face = 0; face < 6; face++) {
+    // One quadrant of the face starts every cycle once.
+    int k = 0;
+    for (int row = 0; row < N / 2; row++) {
+      for (int col = 0; col < (N + 1) / 2; col++) {
+        cycles.faces[face][k++] =
+            make_cycle<N>(face * N * N + row * N + col, FACE_NORMALS[face]);
+      }
+    }
+  }
+  return cycles;
+}
+
+template <typename Sticker, typename Cycles>
+constexpr void cycle_stickers(Sticker *stickers, const Cycles &cycles,
+                              int power) {
+  for (const auto &c : cycles) {
+    switch (power) {
+    case 1: {
+      auto last = stickers[c[3]];
+      stickers[c[3]] = stickers[c[2]];
+      stickers[c[2]] = stickers[c[1]];
+      stickers[c[1]] = stickers[c[0]];
+      stickers[c[0]] = last;
+      break;
+    }
+    case 2:
+      std::swap(stickers[c[0]], stickers[c[2]]);
+      std::swap(stickers[c[1]], stickers[c[3]]);
+      break;
+    case 3: {
+      auto first = stickers[c[0]];
+      stickers[c[0]] = stickers[c[1]];
+      stickers[c[1]] = stickers[c[2]];
+      stickers[c[2]] = stickers[c[3]];
+      stickers[c[3]] = first;
+      break;
+    }
+    }
+  }
+}
+
+} // namespace detail
+
+template <int N, typename Sticker>
+constexpr void apply_layer_move(Sticker *stickers, const LayerCycles<N> &cycles,
+                                LayerMove m) {
+  int face = static_cast<int>(m.face);
+  if (face < 3) {
+    detail::cycle_stickers(stickers, cycles.strips[face][m.depth], m.power);
+  } else {
+    detail::cycle_stickers(stickers, cycles.strips[face - 3][N - 1 - m.depth],
+                           4 - m.power);
+  }
+  if (m.depth == 0) {
+    detail::cycle_stickers(stickers, cycles.faces[face], m.power);
+  }
+  if (m.depth == N - 1) {
+    detail::cycle_stickers(stickers, cycles.faces[(face + 3) % 6],
+                           4 - m.power);
+  }
+}
+
+// Cycles are generated at compile time up to this size, larger cubes build
+// them on first use since constant evaluation gets slow quickly.
+constexpr int CONSTEXPR_LAYER_MAX_N = 7;
+
+template <int N> const LayerCycles<N> &layer_cycles() {
+  if constexpr (N <= CONSTEXPR_LAYER_MAX_N) {
+    static constexpr LayerCycles<N> cycles = detail::make_layer_cycles<N>();
+    return cycles;
+  } else {
+    static const LayerCycles<N> cycles = detail::make_layer_cycles<N>();
+    return cycles;
+  }
+}
+
+template <int N, typename Sticker>
+void apply_layer_move(Sticker *stickers, LayerMove m) {
+  apply_layer_move<N>(stickers, layer_cycles<N>(), m);
+}
+
+} // namespace cube
+
+#endif // LAYER_HXX
@@ -0,0 +1,91 @@
+#ifndef LEHMER_HXX
+#define LEHMER_HXX
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+namespace cube {
+
+// Arrangements of more elements do not fit the masks and ranks.
+constexpr int LEHMER_MAX_ELEMENTS = 16;
+
+/* NOTE: The Lehmer digit of an element is the number of smaller elements
+ not used before it, one popcount on the mask of used elements. Unranking
+ picks the element with that many smaller unused ones, the digit-th set bit
+ of the unused mask. For a whole permutation the digit equals the number of
+ smaller elements after it, so the ranks are the classic Lehmer ranks with
+ the identity at 0. */
+
+// Rank of values[0..k), k distinct elements out of 0 .. n - 1, among the
+// n! / (n - k)! arrangements.
+template <typename T>
+constexpr int rank_arrangement(const T *values, int k, int n) {
+  int rank = 0;
+#if defined(__POPCNT__)
+  uint32_t used = 0;
+  for (int i = 0; i < k; i++) {
+    uint32_t bit = uint32_t{1} << values[i];
+    rank = rank * (n - i) + (values[i] - std::popcount(used & (bit - 1)));
+    used |= bit;
+  }
+#else
+  // Without a popcount instruction, nibble v of below counts the used
+  // elements smaller than v and every element bumps the nibbles above it.
+  uint64_t below = 0;
+  for (int i = 0; i < k; i++) {
+    int v = values[i];
+    rank = rank * (n - i) + (v - static_cast<int>((below >> (4 * v)) & 0xf));
+    below += (uint64_t{0x1111111111111111} << 4) << (4 * v);
+  }
+#endif
+  return rank;
+}
+
+// The digit-th set bit of mask.
+constexpr int select_bit(uint32_t mask, int digit) {
+#if defined(__BMI2__)
+  if (!std::is_constant_evaluated()) {
+    return std::countr_zero(_pdep_u32(uint32_t{1} << digit, mask));
+  }
+#endif
+  for (; digit > 0; digit--) {
+    mask &= mask - 1;
+  }
+  return std::countr_zero(mask);
+}
+
+template <typename T>
+constexpr void unrank_arrangement(int rank, T *values, int k, int n) {
+  int digits[LEHMER_MAX_ELEMENTS] = {};
+  for (int i = k - 1; i >= 0; i--) {
+    digits[i] = rank % (n - i);
+    rank /= n - i;
+  }
+  uint32_t unused = (uint32_t{1} << n) - 1;
+  for (int i = 0; i < k; i++) {
+    int value = select_bit(unused, digits[i]);
+    values[i] = static_cast<T>(value);
+    unused &= ~(uint32_t{1} << value);
+  }
+}
+
+template <size_t N>
+constexpr int rank_permutation(const std::array<uint8_t, N> &perm) {
+  return rank_arrangement(perm.data(), N, N);
+}
+
+template <size_t N>
+constexpr std::array<uint8_t, N> unrank_permutation(int rank) {
+  std::array<uint8_t, N> perm{};
+  unrank_arrangement(rank, perm.data(), N, N);
+  return perm;
+}
+
+} // namespace cube
+
+#endif // LEHMER_HXX
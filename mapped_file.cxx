@@ -0,0 +1,181 @@
+#include "mapped_file.hxx"
+#include <stdexcept>
+#include <utility>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(uint8_t *data, size_t size, intptr_t file)
+    : m_data(data), m_size(size), m_file(file) {}
+
+MappedFile::MappedFile(MappedFile &&other)
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)),
+      m_file(std::exchange(other.m_file, -1)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) {
+  if (this != &other) {
+    unmap();
+    m_data = std::exchange(other.m_data, nullptr);
+    m_size = std::exchange(other.m_size, 0);
+    m_file = std::exchange(other.m_file, -1);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() { unmap(); }
+
+#ifdef _WIN32
+
+MappedFile MappedFile::create(const std::string &path, size_t size) {
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0,
+                            nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error("Failed to create " + path);
+  }
+  auto size64 = static_cast<uint64_t>(size);
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READWRITE, size64 >> 32,
+                         size64 & 0xffffffff, nullptr);
+  if (mapping == nullptr) {
+    CloseHandle(file);
+    throw std::runtime_error("Failed to map " + path);
+  }
+  // The view keeps the mapping alive on its own.
+  void *view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+  CloseHandle(mapping);
+  if (view == nullptr) {
+    CloseHandle(file);
+    throw std::runtime_error("Failed to map " + path);
+  }
+  return MappedFile(static_cast<uint8_t *>(view), size,
+                    reinterpret_cast<intptr_t>(file));
+}
+
+std::optional<MappedFile> MappedFile::open_read_only(const std::string &path) {
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return {};
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    return {};
+  }
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr) {
+    return {};
+  }
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (view == nullptr) {
+    return {};
+  }
+  return MappedFile(static_cast<uint8_t *>(view),
+                    static_cast<size_t>(size.QuadPart));
+}
+
+void MappedFile::sync() {
+  if (m_data == nullptr) {
+    return;
+  }
+  // FlushViewOfFile only starts the writes, flushing the file waits for them.
+  if (!FlushViewOfFile(m_data, m_size) ||
+      (m_file != -1 && !FlushFileBuffers(reinterpret_cast<HANDLE>(m_file)))) {
+    throw std::runtime_error("Failed to sync a mapped file");
+  }
+}
+
+void MappedFile::unmap() {
+  if (m_data != nullptr) {
+    UnmapViewOfFile(m_data);
+    m_data = nullptr;
+    m_size = 0;
+  }
+  if (m_file != -1) {
+    CloseHandle(reinterpret_cast<HANDLE>(m_file));
+    m_file = -1;
+  }
+}
+
+#else
+
+static std::runtime_error system_error(const std::string &what,
+                                       const std::string &path) {
+  return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+}
+
+MappedFile MappedFile::create(const std::string &path, size_t size) {
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw system_error("Failed to create", path);
+  }
+  if (ftruncate(fd, size) != 0) {
+    auto error = system_error("Failed to resize", path);
+    close(fd);
+    throw error;
+  }
+  void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    auto error = system_error("Failed to map", path);
+    close(fd);
+    throw error;
+  }
+  return MappedFile(static_cast<uint8_t *>(data), size, fd);
+}
+
+std::optional<MappedFile> MappedFile::open_read_only(const std::string &path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return {};
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    close(fd);
+    return {};
+  }
+  size_t size = info.st_size;
+  void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    return {};
+  }
+  return MappedFile(static_cast<uint8_t *>(data), size);
+}
+
+void MappedFile::sync() {
+  if (m_data == nullptr) {
+    return;
+  }
+  if (msync(m_data, m_size, MS_SYNC) != 0 ||
+      (m_file >= 0 && fsync(static_cast<int>(m_file)) != 0)) {
+    throw std::runtime_error(std::string("Failed to sync a mapped file: ") +
+                             std::strerror(errno));
+  }
+}
+
+void MappedFile::unmap() {
+  if (m_data != nullptr) {
+    munmap(m_data, m_size);
+    m_data = nullptr;
+    m_size = 0;
+  }
+  if (m_file >= 0) {
+    close(static_cast<int>(m_file));
+    m_file = -1;
+  }
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef MAPPED_FILE_HXX
+#define MAPPED_FILE_HXX
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// A file mapped into memory, unmapped when the last owner goes away.
+class MappedFile {
+public:
+  // Creates or truncates the file at path to size bytes and maps it
+  // writable. Throws std::runtime_error on failure.
+  static MappedFile create(const std::string &path, size_t size);
+
+  // Maps an existing file read only. Pages are shared with every other
+  // process mapping the same file and only read from disk when touched.
+  // Returns nothing if the file cannot be opened or mapped.
+  static std::optional<MappedFile> open_read_only(const std::string &path);
+
+  MappedFile(MappedFile &&other);
+  MappedFile &operator=(MappedFile &&other);
+  MappedFile(const MappedFile &other) = delete;
+  MappedFile &operator=(const MappedFile &other) = delete;
+  ~MappedFile();
+
+  uint8_t *data() { return m_data; }
+  const uint8_t *data() const { return m_data; }
+  size_t size() const { return m_size; }
+
+  // Blocks until the written pages and the file they belong to have
+  // reached the disk. Throws std::runtime_error on failure.
+  void sync();
+
+private:
+  MappedFile(uint8_t *data, size_t size, intptr_t file = -1);
+  void unmap();
+
+  uint8_t *m_data = nullptr;
+  size_t m_size = 0;
+  // Created files stay open for sync(), a descriptor or a HANDLE. -1 for
+  // read only mappings.
+  intptr_t m_file = -1;
+};
+
+#endif // MAPPED_FILE_HXX
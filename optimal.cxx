@@ -0,0 +1,508 @@
+#include "optimal.hxx"
+#include "canonical.hxx"
+#include "lehmer.hxx"
+#include "tables.hxx"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <stdexcept>
+
+using cube::Move;
+using cube::MOVE_COUNT;
+
+namespace solver {
+
+// Iterations at least this deep are searched in parallel, split into the
+// subtrees SPLIT_DEPTH moves below the root. Three moves give a few thousand
+// subtrees, plenty to keep every core busy until the last ones finish.
+static constexpr int PARALLEL_MIN_DEPTH = 12;
+static constexpr int SPLIT_DEPTH = 3;
+
+EdgeLocations edge_locations(const cube::CubieCube &cc) {
+  return cc.inverse().edges;
+}
+
+size_t edge_group_index(const EdgeLocations &locations, int first) {
+  std::array<uint8_t, EDGE_GROUP_SIZE> group;
+  size_t ori = 0;
+  for (int i = 0; i < EDGE_GROUP_SIZE; i++) {
+    group[i] = locations[first + i] & cube::CubieCube::EDGE_PERM_MASK;
+    ori = ori * 2 + (locations[first + i] >> cube::CubieCube::EDGE_ORI_SHIFT);
+  }
+  size_t rank =
+      cube::rank_arrangement(group.data(), EDGE_GROUP_SIZE, cube::EDGE_COUNT);
+  return rank * 64 + ori;
+}
+
+void set_edge_group(EdgeLocations &locations, int first, size_t index) {
+  size_t ori = index % 64;
+  std::array<uint8_t, EDGE_GROUP_SIZE> group;
+  cube::unrank_arrangement(static_cast<int>(index / 64), group.data(),
+                           EDGE_GROUP_SIZE, cube::EDGE_COUNT);
+  for (int i = 0; i < EDGE_GROUP_SIZE; i++) {
+    int flip = (ori >> (EDGE_GROUP_SIZE - 1 - i)) & 1;
+    locations[first + i] =
+        group[i] | (flip << cube::CubieCube::EDGE_ORI_SHIFT);
+  }
+}
+
+OptimalTables::OptimalTables()
+    : corners(open_table(TableKind::CORNERS)),
+      edges_low(open_table(TableKind::EDGES_LOW)),
+      edges_high(open_table(TableKind::EDGES_HIGH)),
+      m_symmetries(cube::SymmetryTables::instance()) {}
+
+const OptimalTables &OptimalTables::instance() {
+  static OptimalTables tables;
+  return tables;
+}
+
+namespace {
+
+// A node SPLIT_DEPTH moves below the root, searched as one pool task.
+struct SubTree {
+  std::array<Move, SPLIT_DEPTH> prefix;
+  int corner_perm;
+  int twist;
+  EdgeLocations edges;
+};
+
+struct OptimalSearch {
+  const cube::MoveTables &mt;
+  const OptimalTables &pt;
+  // Set once any thread has found a solution of the current length.
+  const std::atomic<bool> *cancelled = nullptr;
+  std::array<Move, MAX_OPTIMAL_DEPTH> path{};
+  uint64_t nodes = 0;
+
+  int bound(int corner_perm, int twist, const EdgeLocations &edges) const {
+    int b = pt.corners.get(pt.corner_index(corner_perm, twist));
+    b = std::max<int>(b, pt.edges_low.get(edge_group_index(edges, 0)));
+    return std::max<int>(
+        b, pt.edges_high.get(edge_group_index(edges, EDGE_GROUP_SIZE)));
+  }
+
+  /* Calls visit(ncorner_perm, ntwist, nedges) for every child that may
+   still lead to a solution in togo moves, with path[depth] set to the move.
+   Stops as soon as visit returns true. The database entries of the children
+   are all over memory, so the children are prepared in passes: the corner
+   entries of all of them are prefetched before the first one is read, then
+   the edge entries of the survivors, and the misses overlap instead of
+   coming one after the other. */
+  template <typename Visit>
+  bool for_each_child(int corner_perm, int twist, const EdgeLocations &edges,
+                      int depth, int togo, Visit visit) {
+    struct Child {
+      Move m;
+      int corner_perm;
+      int twist;
+      size_t corner_index;
+      EdgeLocations edges;
+      size_t low_index;
+      size_t high_index;
+    };
+    std::array<Child, MOVE_COUNT> children;
+    int count = 0;
+
+    auto moves = cube::canonical_moves(
+        depth > 0 ? cube::canonical_state_after(path[depth - 1])
+                  : cube::CANONICAL_START);
+    for (; moves != 0; moves &= moves - 1) {
+      int i = std::countr_zero(moves);
+      auto &child = children[count++];
+      child.m = static_cast<Move>(i);
+      child.corner_perm = mt.corners[corner_perm * MOVE_COUNT + i];
+      child.twist = mt.twist[twist * MOVE_COUNT + i];
+      child.corner_index = pt.corner_index(child.corner_perm, child.twist);
+      pt.corners.prefetch(child.corner_index);
+    }
+
+    int survivors = 0;
+    for (int c = 0; c < count; c++) {
+      auto &child = children[c];
+      if (pt.corners.get(child.corner_index) >= togo) {
+        continue;
+      }
+      child.edges = edges;
+      move_edge_locations(child.edges, child.m);
+      child.low_index = edge_group_index(child.edges, 0);
+      child.high_index = edge_group_index(child.edges, EDGE_GROUP_SIZE);
+      pt.edges_low.prefetch(child.low_index);
+      pt.edges_high.prefetch(child.high_index);
+      children[survivors++] = child;
+    }
+
+    for (int c = 0; c < survivors; c++) {
+      const auto &child = children[c];
+      if (pt.edges_low.get(child.low_index) >= togo ||
+          pt.edges_high.get(child.high_index) >= togo) {
+        continue;
+      }
+      path[depth] = child.m;
+      if (visit(child.corner_perm, child.twist, child.edges)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Only called with nodes whose bound is below togo, so togo == 0 means
+  // every database reads zero and the cube is solved.
+  bool search(int corner_perm, int twist, const EdgeLocations &edges,
+              int depth, int togo) {
+    nodes++;
+    if (togo == 0) {
+      return true;
+    }
+    if (cancelled && cancelled->load(std::memory_order_relaxed)) {
+      return false;
+    }
+    return for_each_child(
+        corner_perm, twist, edges, depth, togo,
+        [&](int ncorner_perm, int ntwist, const EdgeLocations &nedges) {
+          return search(ncorner_perm, ntwist, nedges, depth + 1, togo - 1);
+        });
+  }
+
+  // Collects the nodes SPLIT_DEPTH moves deep that survive pruning.
+  void split(int corner_perm, int twist, const EdgeLocations &edges, int depth,
+             int togo, std::vector<SubTree> &subtrees) {
+    if (depth == SPLIT_DEPTH) {
+      SubTree subtree{{}, corner_perm, twist, edges};
+      std::copy_n(path.begin(), SPLIT_DEPTH, subtree.prefix.begin());
+      subtrees.push_back(subtree);
+      return;
+    }
+    for_each_child(
+        corner_perm, twist, edges, depth, togo,
+        [&](int ncorner_perm, int ntwist, const EdgeLocations &nedges) {
+          split(ncorner_perm, ntwist, nedges, depth + 1, togo - 1, subtrees);
+          return false;
+        });
+  }
+};
+
+using Prefix = std::array<Move, SPLIT_DEPTH>;
+
+struct CheckpointHeader {
+  static constexpr char MAGIC[8] = {'R', 'U', 'B', 'I', 'K', 'S', 'C', 'P'};
+
+  char magic[8];
+  uint32_t format_version;
+  uint32_t depth;
+  uint64_t nodes;
+  uint64_t remaining_count;
+  std::array<uint8_t, cube::CORNER_COUNT> corners;
+  std::array<uint8_t, cube::EDGE_COUNT> edges;
+  uint8_t reserved[12];
+};
+static_assert(sizeof(CheckpointHeader) == 64);
+
+constexpr uint32_t CHECKPOINT_FORMAT_VERSION = 1;
+
+// An iteration has at most one subtree per canonical prefix.
+constexpr uint64_t MAX_SUBTREE_COUNT = [] {
+  std::array<uint64_t, cube::CANONICAL_STATE_COUNT> counts{};
+  counts[cube::CANONICAL_START] = 1;
+  for (int d = 0; d < SPLIT_DEPTH; d++) {
+    std::array<uint64_t, cube::CANONICAL_STATE_COUNT> next{};
+    for (int state = 0; state < cube::CANONICAL_STATE_COUNT; state++) {
+      for (int m = 0; m < MOVE_COUNT; m++) {
+        auto to = cube::canonical_next(state, static_cast<Move>(m));
+        if (to != cube::CANONICAL_REJECT) {
+          next[to] += counts[state];
+        }
+      }
+    }
+    counts = next;
+  }
+  uint64_t total = 0;
+  for (auto count : counts) {
+    total += count;
+  }
+  return total;
+}();
+
+} // namespace
+
+/* NOTE: A checkpoint holds the cube, the bound of the deep iteration under
+ way, the nodes expanded so far and the prefixes of the subtrees of that
+ iteration that have not been searched completely. Subtrees being searched
+ while it is written count as not searched and start over on resume. The
+ file is a header followed by the prefixes, written next to the old one and
+ renamed over it so a kill while writing keeps the previous checkpoint. */
+struct OptimalSolver::Checkpoint {
+  std::string path;
+  std::chrono::seconds interval;
+  cube::CubieCube cube;
+  int depth = 0;
+  uint64_t nodes = 0;
+  std::vector<Prefix> remaining{};
+  // Set while remaining still needs to be searched for depth.
+  bool resume = false;
+
+  // Saves with the nodes of the running iteration added.
+  void save(uint64_t iteration_nodes) const {
+    CheckpointHeader header{};
+    std::memcpy(header.magic, CheckpointHeader::MAGIC, sizeof(header.magic));
+    header.format_version = CHECKPOINT_FORMAT_VERSION;
+    header.depth = depth;
+    header.nodes = nodes + iteration_nodes;
+    header.remaining_count = remaining.size();
+    header.corners = cube.corners;
+    header.edges = cube.edges;
+
+    auto partial_path = path + ".partial";
+    {
+      std::ofstream out(partial_path, std::ios::binary | std::ios::trunc);
+      out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      out.write(reinterpret_cast<const char *>(remaining.data()),
+                remaining.size() * sizeof(Prefix));
+      if (!out.flush()) {
+        throw std::runtime_error("Could not write checkpoint " + path + "!");
+      }
+    }
+    std::filesystem::rename(partial_path, path);
+  }
+
+  // Returns false if there is no valid checkpoint of the cube at path.
+  bool load() {
+    std::error_code error;
+    auto file_size = std::filesystem::file_size(path, error);
+    std::ifstream in(path, std::ios::binary);
+    CheckpointHeader header;
+    if (error || !in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, CheckpointHeader::MAGIC,
+                    sizeof(header.magic)) != 0 ||
+        header.format_version != CHECKPOINT_FORMAT_VERSION ||
+        header.corners != cube.corners || header.edges != cube.edges ||
+        header.depth > MAX_OPTIMAL_DEPTH) {
+      return false;
+    }
+    // Checked before allocating, a corrupt count could be anything.
+    if (header.remaining_count > MAX_SUBTREE_COUNT ||
+        file_size !=
+            sizeof(header) + header.remaining_count * sizeof(Prefix)) {
+      return false;
+    }
+    std::vector<Prefix> prefixes(header.remaining_count);
+    if (!in.read(reinterpret_cast<char *>(prefixes.data()),
+                 prefixes.size() * sizeof(Prefix))) {
+      return false;
+    }
+    for (const auto &prefix : prefixes) {
+      for (auto m : prefix) {
+        if (static_cast<int>(m) >= MOVE_COUNT) {
+          return false;
+        }
+      }
+    }
+    depth = header.depth;
+    nodes = header.nodes;
+    remaining = std::move(prefixes);
+    resume = true;
+    return true;
+  }
+};
+
+OptimalSolver::OptimalSolver(unsigned thread_count)
+    : m_moves(cube::MoveTables::instance()),
+      m_tables(OptimalTables::instance()), m_thread_count(thread_count) {
+  if (m_thread_count == 0) {
+    m_thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+/* NOTE: Deep iterations are split into the subtrees SPLIT_DEPTH moves below
+ the root, which the pool searches with the same bound. The first thread to
+ find a solution cancels the others, any solution of the current length is
+ optimal so it does not matter which one wins. */
+std::optional<std::vector<Move>>
+OptimalSolver::search_parallel(ThreadPool &pool, int corner_perm, int twist,
+                               const EdgeLocations &edges, int depth,
+                               Checkpoint *checkpoint) const {
+  std::vector<SubTree> subtrees;
+  if (checkpoint && checkpoint->resume) {
+    // Where the saved prefixes lead, they passed the pruning already.
+    for (const auto &prefix : checkpoint->remaining) {
+      SubTree subtree{prefix, corner_perm, twist, edges};
+      for (auto m : prefix) {
+        int i = static_cast<int>(m);
+        subtree.corner_perm =
+            m_moves.corners[subtree.corner_perm * MOVE_COUNT + i];
+        subtree.twist = m_moves.twist[subtree.twist * MOVE_COUNT + i];
+        move_edge_locations(subtree.edges, m);
+      }
+      subtrees.push_back(subtree);
+    }
+    checkpoint->resume = false;
+  } else {
+    OptimalSearch{m_moves, m_tables}.split(corner_perm, twist, edges, 0, depth,
+                                           subtrees);
+  }
+
+  std::atomic<bool> found = false;
+  std::mutex solution_mutex;
+  std::vector<Move> solution;
+  // Progress of the iteration, guarded by progress_mutex. Only subtrees
+  // searched to the end count as finished, not the ones cut short by a
+  // solution elsewhere.
+  std::mutex progress_mutex;
+  std::condition_variable progress_made;
+  std::vector<bool> finished(subtrees.size());
+  size_t returned_count = 0;
+  uint64_t nodes = 0;
+
+  // Saves the subtrees not finished yet.
+  auto save = [&]() {
+    checkpoint->depth = depth;
+    checkpoint->remaining.clear();
+    for (size_t t = 0; t < subtrees.size(); t++) {
+      if (!finished[t]) {
+        checkpoint->remaining.push_back(subtrees[t].prefix);
+      }
+    }
+    checkpoint->save(nodes);
+  };
+  // Written before any task runs, a failure cannot leave tasks behind.
+  if (checkpoint) {
+    save();
+  }
+
+  for (size_t t = 0; t < subtrees.size(); t++) {
+    pool.submit([&, t]() {
+      const auto &subtree = subtrees[t];
+      OptimalSearch search{m_moves, m_tables, &found};
+      std::copy(subtree.prefix.begin(), subtree.prefix.end(),
+                search.path.begin());
+      bool solved = search.search(subtree.corner_perm, subtree.twist,
+                                  subtree.edges, SPLIT_DEPTH,
+                                  depth - SPLIT_DEPTH);
+      if (solved && !found.exchange(true)) {
+        std::lock_guard lock(solution_mutex);
+        solution.assign(search.path.begin(), search.path.begin() + depth);
+      }
+      // A search only gives up early once found is set.
+      bool complete = solved || !found.load();
+      {
+        std::lock_guard lock(progress_mutex);
+        finished[t] = complete;
+        returned_count++;
+        nodes += search.nodes;
+      }
+      progress_made.notify_one();
+    });
+  }
+
+  if (checkpoint) {
+    auto all_returned = [&]() { return returned_count == subtrees.size(); };
+    std::unique_lock lock(progress_mutex);
+    auto next_save = std::chrono::steady_clock::now() + checkpoint->interval;
+    while (!progress_made.wait_until(lock, next_save, all_returned)) {
+      // The iteration is about to end once a solution is found.
+      if (found) {
+        progress_made.wait(lock, all_returned);
+        break;
+      }
+      try {
+        save();
+      } catch (...) {
+        // The tasks refer to the locals here, they have to stop first.
+        found = true;
+        lock.unlock();
+        pool.wait();
+        throw;
+      }
+      next_save = std::chrono::steady_clock::now() + checkpoint->interval;
+    }
+    checkpoint->nodes += nodes;
+  }
+  pool.wait();
+
+  if (!found) {
+    return {};
+  }
+  return solution;
+}
+
+std::vector<Move> OptimalSolver::solve(const cube::CubieCube &cc) const {
+  if (!cc.is_valid()) {
+    throw std::invalid_argument("Cannot solve an unreachable cube state!");
+  }
+
+  OptimalSearch search{m_moves, m_tables};
+  int corner_perm = cube::get_corners(cc);
+  int twist = cube::get_twist(cc);
+  auto edges = edge_locations(cc);
+
+  // Started on the first deep iteration, shallow ones finish faster than the
+  // threads would start.
+  std::optional<ThreadPool> pool;
+  for (int depth = search.bound(corner_perm, twist, edges);
+       depth <= MAX_OPTIMAL_DEPTH; depth++) {
+    if (m_thread_count > 1 && depth >= PARALLEL_MIN_DEPTH) {
+      if (!pool) {
+        pool.emplace(m_thread_count);
+      }
+      if (auto solution =
+              search_parallel(*pool, corner_perm, twist, edges, depth)) {
+        return *solution;
+      }
+    } else if (search.search(corner_perm, twist, edges, 0, depth)) {
+      return std::vector<Move>(search.path.begin(),
+                               search.path.begin() + depth);
+    }
+  }
+  throw std::logic_error("No solution within God's number, tables are broken!");
+}
+
+std::vector<Move> OptimalSolver::solve(const cube::CubieCube &cc,
+                                       const std::string &checkpoint_path,
+                                       std::chrono::seconds interval) const {
+  if (!cc.is_valid()) {
+    throw std::invalid_argument("Cannot solve an unreachable cube state!");
+  }
+
+  Checkpoint checkpoint{checkpoint_path, interval, cc};
+  checkpoint.load();
+
+  OptimalSearch search{m_moves, m_tables};
+  int corner_perm = cube::get_corners(cc);
+  int twist = cube::get_twist(cc);
+  auto edges = edge_locations(cc);
+
+  // Deep iterations always go through the pool, where they are saved.
+  std::optional<ThreadPool> pool;
+  for (int depth = std::max(search.bound(corner_perm, twist, edges),
+                            checkpoint.depth);
+       depth <= MAX_OPTIMAL_DEPTH; depth++) {
+    std::optional<std::vector<Move>> solution;
+    if (depth >= PARALLEL_MIN_DEPTH) {
+      if (!pool) {
+        pool.emplace(m_thread_count);
+      }
+      solution = search_parallel(*pool, corner_perm, twist, edges, depth,
+                                 &checkpoint);
+    } else {
+      search.nodes = 0;
+      if (search.search(corner_perm, twist, edges, 0, depth)) {
+        solution.emplace(search.path.begin(), search.path.begin() + depth);
+      }
+      checkpoint.nodes += search.nodes;
+    }
+    if (solution) {
+      std::error_code ignored;
+      std::filesystem::remove(checkpoint_path, ignored);
+      return *solution;
+    }
+  }
+  throw std::logic_error("No solution within God's number, tables are broken!");
+}
+
+} // namespace solver
@@ -0,0 +1,111 @@
+#ifndef OPTIMAL_HXX
+#define OPTIMAL_HXX
+#include "coord.hxx"
+#include "cube.hxx"
+#include "prune.hxx"
+#include "symmetry.hxx"
+#include "thread_pool.hxx"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace solver {
+
+// God's number in the half turn metric is 20.
+constexpr int MAX_OPTIMAL_DEPTH = 20;
+
+// Checkpointed searches save their progress at most this often.
+constexpr std::chrono::seconds DEFAULT_CHECKPOINT_INTERVAL{60};
+
+constexpr int EDGE_GROUP_SIZE = 6;
+constexpr size_t EDGE_GROUP_STATE_COUNT = 665280 * 64; // 12! / 6! * 2^6
+
+/* NOTE: The edge pattern databases track half of the edges each. An edge
+ group is described by where each of its edges currently is, the edge
+ locations are the edge half of the inverse cube: location | flip << 4 per
+ edge. */
+using EdgeLocations = std::array<uint8_t, cube::EDGE_COUNT>;
+
+EdgeLocations edge_locations(const cube::CubieCube &cc);
+
+inline void move_edge_locations(EdgeLocations &locations, cube::Move m) {
+  // (cc * m)^-1 = m^-1 * cc^-1, so every location is sent through m^-1.
+  const auto &inv = cube::move_cube(cube::inverse(m));
+  for (auto &loc : locations) {
+    loc = inv.edges[loc & cube::CubieCube::EDGE_PERM_MASK] ^
+          (loc & ~cube::CubieCube::EDGE_PERM_MASK);
+  }
+}
+
+// Index of the edges first .. first + EDGE_GROUP_SIZE in an edge group table.
+size_t edge_group_index(const EdgeLocations &locations, int first);
+// Sets the locations of the edges in the group from a table index.
+void set_edge_group(EdgeLocations &locations, int first, size_t index);
+
+// Pattern databases of the optimal solver: the exact distance of all corner
+// states and of the two halves of the edges.
+class OptimalTables {
+public:
+  static const OptimalTables &instance();
+
+  // Index of a corner state in the corner table, which only stores one
+  // state of every class conjugate under the UD symmetries.
+  size_t corner_index(int corner_perm, int twist) const {
+    return m_symmetries.corners_twist_index(corner_perm, twist);
+  }
+
+  PruningTable corners;
+  PruningTable edges_low;
+  PruningTable edges_high;
+
+  OptimalTables(const OptimalTables &other) = delete;
+  OptimalTables &operator=(const OptimalTables &other) = delete;
+
+private:
+  OptimalTables();
+
+  const cube::SymmetryTables &m_symmetries;
+};
+
+/* NOTE: Korf's optimal solver: iterative deepening A* in the half turn
+ metric, bounded by the largest of the corner and edge pattern databases.
+ Much slower than the two-phase solver but the solutions are as short as
+ possible. Deep iterations are spread over thread_count threads, 0 uses
+ every core. */
+class OptimalSolver {
+public:
+  explicit OptimalSolver(unsigned thread_count = 0);
+
+  // Throws std::invalid_argument for unreachable cubes.
+  std::vector<cube::Move> solve(const cube::CubieCube &cc) const;
+
+  /* Like solve(), but deep iterations save their progress to
+   checkpoint_path at most every interval, and a checkpoint of the same cube
+   found there is resumed instead of starting over. The file is removed once
+   the cube is solved. Throws std::runtime_error when the checkpoint cannot
+   be written. */
+  std::vector<cube::Move>
+  solve(const cube::CubieCube &cc, const std::string &checkpoint_path,
+        std::chrono::seconds interval = DEFAULT_CHECKPOINT_INTERVAL) const;
+
+private:
+  struct Checkpoint;
+
+  // One iteration of the search with every thread of the pool, saving the
+  // progress to the checkpoint if there is one.
+  std::optional<std::vector<cube::Move>>
+  search_parallel(ThreadPool &pool, int corner_perm, int twist,
+                  const EdgeLocations &edges, int depth,
+                  Checkpoint *checkpoint = nullptr) const;
+
+  const cube::MoveTables &m_moves;
+  const OptimalTables &m_tables;
+  unsigned m_thread_count;
+};
+
+} // namespace solver
+
+#endif // OPTIMAL_HXX
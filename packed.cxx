@@ -0,0 +1,312 @@
+#include "packed.hxx"
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace cube {
+
+// Strips are split into runs of this many stickers, one cache line of a row.
+static constexpr int STRIP_CHUNK =
+    PackedCube::LINE_WORDS * PackedCube::STICKERS_PER_WORD;
+
+PackedCube::PackedCube(int size, unsigned thread_count)
+    : m_size(size), m_thread_count(thread_count),
+      m_row_words((size + STICKERS_PER_WORD - 1) / STICKERS_PER_WORD),
+      m_stride((m_row_words + LINE_WORDS - 1) / LINE_WORDS * LINE_WORDS) {
+  if (size < 2) {
+    throw std::invalid_argument("A cube needs at least two layers!");
+  }
+  if (m_thread_count == 0) {
+    m_thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (auto &face : m_faces) {
+    face.resize(static_cast<size_t>(m_size) * m_stride);
+  }
+  m_scratch.resize(static_cast<size_t>(m_size) * m_stride);
+  reset();
+}
+
+PackedCube::PackedCube(const PackedCube &other)
+    : m_size(other.m_size), m_thread_count(other.m_thread_count),
+      m_row_words(other.m_row_words), m_stride(other.m_stride),
+      m_faces(other.m_faces), m_scratch(other.m_scratch) {}
+
+PackedCube &PackedCube::operator=(const PackedCube &other) {
+  if (this != &other) {
+    if (other.m_thread_count != m_thread_count) {
+      m_pool.reset();
+    }
+    m_size = other.m_size;
+    m_thread_count = other.m_thread_count;
+    m_row_words = other.m_row_words;
+    m_stride = other.m_stride;
+    m_faces = other.m_faces;
+    m_scratch = other.m_scratch;
+  }
+  return *this;
+}
+
+template <typename Task> void PackedCube::run(int count, Task task) {
+  if (m_thread_count < 2 || m_size < PARALLEL_MIN_SIZE || count < 2) {
+    for (int i = 0; i < count; i++) {
+      task(i);
+    }
+    return;
+  }
+  if (!m_pool) {
+    m_pool = std::make_unique<ThreadPool>(m_thread_count);
+  }
+  for (int i = 0; i < count; i++) {
+    m_pool->submit([&task, i]() { task(i); });
+  }
+  m_pool->wait();
+}
+
+void PackedCube::reset() {
+  for (int face = 0; face < 6; face++) {
+    uint64_t word = 0;
+    for (int i = 0; i < STICKERS_PER_WORD; i++) {
+      word |= uint64_t(face) << (i * STICKER_BITS);
+    }
+    std::fill(m_faces[face].begin(), m_faces[face].end(), word);
+  }
+}
+
+bool PackedCube::is_solved() const {
+  // Compares whole words, the unused stickers at the end of every row hold
+  // garbage and are masked out.
+  for (int face = 0; face < 6; face++) {
+    uint64_t word = 0;
+    uint8_t color = get(face, 0, 0);
+    for (int i = 0; i < STICKERS_PER_WORD; i++) {
+      word |= uint64_t(color) << (i * STICKER_BITS);
+    }
+    int tail = m_size % STICKERS_PER_WORD;
+    uint64_t tail_mask =
+        tail == 0 ? ~uint64_t{0} : (uint64_t{1} << (tail * STICKER_BITS)) - 1;
+    const auto &stickers = m_faces[face];
+    for (int row = 0; row < m_size; row++) {
+      const auto *words = &stickers[static_cast<size_t>(row) * m_stride];
+      for (int w = 0; w + 1 < m_row_words; w++) {
+        if (words[w] != word) {
+          return false;
+        }
+      }
+      if ((words[m_row_words - 1] ^ word) & tail_mask) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+size_t PackedCube::byte_size() const {
+  return (m_faces.size() + 1) * m_scratch.size() * sizeof(uint64_t);
+}
+
+std::array<PackedCube::Strip, 4> PackedCube::strips(int axis, int depth) const {
+  using detail::dot;
+  using detail::sticker_at;
+  using detail::sticker_position;
+  const int n = m_size;
+  auto normal = detail::FACE_NORMALS[axis];
+  int layer = (n - 1) - 2 * depth;
+
+  // On the next face the layer is a whole row or a whole column, whichever
+  // way the distance along the normal changes.
+  int side = (axis + 1) % 3;
+  auto along = [&](int row, int col) {
+    return dot(sticker_position(n, side * n * n + row * n + col), normal);
+  };
+  int base = along(0, 0), row_delta = along(1, 0) - base;
+  int start, next;
+  if (row_delta != 0) {
+    int row = (layer - base) / row_delta;
+    start = side * n * n + row * n;
+    next = start + 1;
+  } else {
+    int col = (layer - base) / (along(0, 1) - base);
+    start = side * n * n + col;
+    next = start + n;
+  }
+
+  // The other three strips are where the first two stickers end up.
+  std::array<Strip, 4> result;
+  auto p = sticker_position(n, start), q = sticker_position(n, next);
+  for (int i = 0; i < 4; i++) {
+    int a = sticker_at(n, p), b = sticker_at(n, q);
+    int ra = a / n % n, ca = a % n;
+    result[i] = {a / (n * n), ra, ca, b / n % n - ra, b % n - ca};
+    p = detail::turn_clockwise(p, normal);
+    q = detail::turn_clockwise(q, normal);
+  }
+  return result;
+}
+
+/* NOTE: Split up, the strips are first copied out and then written back one
+ strip at a time. A chunk covers the stickers whose column, or row for a
+ vertical strip, falls into the same run of STRIP_CHUNK, so two chunks never
+ write to the same word or cache line. */
+void PackedCube::turn_strips(int axis, int depth, int power) {
+  auto s = strips(axis, depth);
+  const int n = m_size;
+  int chunks = (n + STRIP_CHUNK - 1) / STRIP_CHUNK;
+  if (chunks == 1 || m_thread_count < 2 || n < PARALLEL_MIN_SIZE) {
+    for (int k = 0; k < n; k++) {
+      std::array<uint8_t, 4> colors;
+      for (int i = 0; i < 4; i++) {
+        colors[i] = get(s[i].face, s[i].row + k * s[i].row_step,
+                        s[i].col + k * s[i].col_step);
+      }
+      for (int i = 0; i < 4; i++) {
+        const auto &to = s[(i + power) % 4];
+        set(to.face, to.row + k * to.row_step, to.col + k * to.col_step,
+            colors[i]);
+      }
+    }
+    return;
+  }
+
+  std::vector<uint8_t> colors(4 * static_cast<size_t>(n));
+  run(4 * chunks, [&](int task) {
+    const auto &from = s[task / chunks];
+    int begin = task % chunks * STRIP_CHUNK;
+    int end = std::min(begin + STRIP_CHUNK, n);
+    auto *out = &colors[static_cast<size_t>(task / chunks) * n];
+    for (int k = begin; k < end; k++) {
+      out[k] = get(from.face, from.row + k * from.row_step,
+                   from.col + k * from.col_step);
+    }
+  });
+  run(4 * chunks, [&](int task) {
+    int i = task / chunks;
+    const auto &to = s[(i + power) % 4];
+    const auto *in = &colors[static_cast<size_t>(i) * n];
+    // Walk the chunk by position on the face, k counts along the strip.
+    int start = to.row_step == 0 ? to.col : to.row;
+    int step = to.row_step == 0 ? to.col_step : to.row_step;
+    int begin = task % chunks * STRIP_CHUNK;
+    int end = std::min(begin + STRIP_CHUNK, n);
+    for (int x = begin; x < end; x++) {
+      int k = (x - start) * step;
+      set(to.face, to.row + k * to.row_step, to.col + k * to.col_step, in[k]);
+    }
+  });
+}
+
+// Reads count stickers of a packed row starting at col, one word at a time.
+static void unpack_run(const uint64_t *row, int col, int count, uint8_t *out) {
+  constexpr int PER_WORD = PackedCube::STICKERS_PER_WORD;
+  int word = col / PER_WORD, left = PER_WORD - col % PER_WORD;
+  uint64_t bits = row[word] >> (col % PER_WORD * PackedCube::STICKER_BITS);
+  for (int i = 0; i < count; i++) {
+    out[i] = bits & 7;
+    bits >>= PackedCube::STICKER_BITS;
+    if (--left == 0 && i + 1 < count) {
+      bits = row[++word];
+      left = PER_WORD;
+    }
+  }
+}
+
+// Writes count stickers starting at col, the stickers around them are kept.
+static void pack_run(uint64_t *row, int col, int count, const uint8_t *in) {
+  constexpr int PER_WORD = PackedCube::STICKERS_PER_WORD;
+  int word = col / PER_WORD;
+  int shift = col % PER_WORD * PackedCube::STICKER_BITS;
+  uint64_t bits = row[word] & ((uint64_t{1} << shift) - 1);
+  for (int i = 0; i < count; i++) {
+    bits |= uint64_t{in[i]} << shift;
+    shift += PackedCube::STICKER_BITS;
+    if (shift == PER_WORD * PackedCube::STICKER_BITS) {
+      row[word++] = bits;
+      bits = 0;
+      shift = 0;
+    }
+  }
+  if (shift > 0) {
+    uint64_t written = (uint64_t{1} << shift) - 1;
+    row[word] = (row[word] & ~written) | bits;
+  }
+}
+
+/* NOTE: A clockwise turn sends the sticker at (r, c) to (c, n - 1 - r). The
+ face is rotated one TILE x TILE block at a time: the block is unpacked row
+ by row into bytes, and every row of the rotated block is gathered from a
+ column of those bytes and packed into the scratch face. The blocks of a
+ band, a column of blocks for quarter turns and a row of them for half
+ turns, make up TILE whole rows of the turned face and are rotated by the
+ same task. */
+void PackedCube::turn_face(int face, int power) {
+  run((m_size + TILE - 1) / TILE,
+      [&](int band) { turn_band(face, power, band); });
+  std::swap(m_faces[face], m_scratch);
+}
+
+void PackedCube::turn_band(int face, int power, int band) {
+  const int n = m_size;
+  const auto *src = m_faces[face].data();
+  auto *dst = m_scratch.data();
+  alignas(CACHE_LINE) uint8_t tile[TILE][TILE];
+  uint8_t line[TILE];
+
+  for (int other = 0; other < n; other += TILE) {
+    int r0 = power == 2 ? band * TILE : other;
+    int c0 = power == 2 ? other : band * TILE;
+    int h = std::min(TILE, n - r0);
+    int w = std::min(TILE, n - c0);
+    for (int r = 0; r < h; r++) {
+      unpack_run(src + static_cast<size_t>(r0 + r) * m_stride, c0, w, tile[r]);
+    }
+
+    switch (power) {
+    case 1:
+      // Column c of the block, bottom up, becomes row c0 + c.
+      for (int c = 0; c < w; c++) {
+        for (int j = 0; j < h; j++) {
+          line[j] = tile[h - 1 - j][c];
+        }
+        pack_run(dst + static_cast<size_t>(c0 + c) * m_stride, n - r0 - h, h,
+                 line);
+      }
+      break;
+    case 2:
+      // Row r of the block, reversed, becomes row n - 1 - r0 - r.
+      for (int r = 0; r < h; r++) {
+        for (int j = 0; j < w; j++) {
+          line[j] = tile[r][w - 1 - j];
+        }
+        pack_run(dst + static_cast<size_t>(n - 1 - r0 - r) * m_stride,
+                 n - c0 - w, w, line);
+      }
+      break;
+    case 3:
+      // Column c of the block, top down, becomes row n - 1 - c0 - c.
+      for (int c = 0; c < w; c++) {
+        for (int j = 0; j < h; j++) {
+          line[j] = tile[j][c];
+        }
+        pack_run(dst + static_cast<size_t>(n - 1 - c0 - c) * m_stride, r0, h,
+                 line);
+      }
+      break;
+    }
+  }
+}
+
+void PackedCube::apply(LayerMove m) {
+  int face = static_cast<int>(m.face);
+  if (face < 3) {
+    turn_strips(face, m.depth, m.power);
+  } else {
+    turn_strips(face - 3, m_size - 1 - m.depth, 4 - m.power);
+  }
+  if (m.depth == 0) {
+    turn_face(face, m.power);
+  }
+  if (m.depth == m_size - 1) {
+    turn_face((face + 3) % 6, 4 - m.power);
+  }
+}
+
+} // namespace cube
@@ -0,0 +1,115 @@
+#ifndef PACKED_HXX
+#define PACKED_HXX
+#include "cube.hxx"
+#include "layer.hxx"
+#include "thread_pool.hxx"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace cube {
+
+/* NOTE: Sticker storage for cubes with hundreds or thousands of layers,
+ where a byte per sticker and precomputed layer cycles no longer fit in any
+ cache. Every face is its own bit array with 21 stickers of 3 bits in each
+ 64 bit word and every row starting on a new word. Strips are walked with
+ plain index math. Turning a face is a 90 degree rotation of its matrix,
+ done a tile at a time into a scratch face so that both the reads and the
+ writes stay in cache.
+
+ Rows are padded to whole cache lines. Cubes of PARALLEL_MIN_SIZE layers and
+ more may spread a turn over a thread pool, in chunks that never share a
+ cache line: bands of rows of the turned face and runs of whole lines along
+ the strips. A turn returns once every chunk is done, so the cube is as
+ thread safe as any other value type. */
+class PackedCube {
+public:
+  static constexpr int STICKER_BITS = 3;
+  static constexpr int STICKERS_PER_WORD = 64 / STICKER_BITS;
+  static constexpr int CACHE_LINE = 64;
+  static constexpr int LINE_WORDS = CACHE_LINE / sizeof(uint64_t);
+  // Side of the square blocks the face rotation works on, a multiple of
+  // STICKERS_PER_WORD so source rows are read in whole words.
+  static constexpr int TILE = 4 * STICKERS_PER_WORD;
+  // Smaller cubes turn faster than the threads would pick up the work.
+  static constexpr int PARALLEL_MIN_SIZE = 512;
+
+  // Turns run on thread_count threads, 0 uses every core.
+  explicit PackedCube(int size, unsigned thread_count = 1);
+
+  // Copies get a pool of their own once they need one.
+  PackedCube(const PackedCube &other);
+  PackedCube &operator=(const PackedCube &other);
+  PackedCube(PackedCube &&other) = default;
+  PackedCube &operator=(PackedCube &&other) = default;
+
+  int size() const { return m_size; }
+
+  uint8_t get(int face, int row, int col) const {
+    auto word = m_faces[face][row * m_stride + col / STICKERS_PER_WORD];
+    return (word >> (col % STICKERS_PER_WORD * STICKER_BITS)) & 7;
+  }
+
+  void set(int face, int row, int col, uint8_t color) {
+    auto &word = m_faces[face][row * m_stride + col / STICKERS_PER_WORD];
+    auto shift = col % STICKERS_PER_WORD * STICKER_BITS;
+    word = (word & ~(uint64_t{7} << shift)) | (uint64_t{color} << shift);
+  }
+
+  void apply(LayerMove m);
+  void reset();
+  bool is_solved() const;
+
+  // Bytes used by the stickers.
+  size_t byte_size() const;
+
+private:
+  // Hands out memory starting on a cache line.
+  template <typename T> struct LineAllocator {
+    using value_type = T;
+
+    LineAllocator() = default;
+    template <typename U> LineAllocator(const LineAllocator<U> &) {}
+
+    T *allocate(size_t count) {
+      return static_cast<T *>(::operator new(
+          count * sizeof(T), std::align_val_t{CACHE_LINE}));
+    }
+    void deallocate(T *p, size_t) {
+      ::operator delete(p, std::align_val_t{CACHE_LINE});
+    }
+    bool operator==(const LineAllocator &) const { return true; }
+  };
+  using Words = std::vector<uint64_t, LineAllocator<uint64_t>>;
+
+  // The stickers of a layer on one side face: sticker k sits at
+  // (row + k * row_step, col + k * col_step).
+  struct Strip {
+    int face, row, col, row_step, col_step;
+  };
+
+  std::array<Strip, 4> strips(int axis, int depth) const;
+  void turn_strips(int axis, int depth, int power);
+  void turn_face(int face, int power);
+  void turn_band(int face, int power, int band);
+
+  // Calls task(i) for i from 0 to count - 1, on the pool if there is one.
+  template <typename Task> void run(int count, Task task);
+
+  int m_size;
+  unsigned m_thread_count;
+  // Words holding the stickers of a row, and words from one row to the next.
+  int m_row_words;
+  int m_stride;
+  std::array<Words, 6> m_faces;
+  // Receives a turned face, then swaps places with it.
+  Words m_scratch;
+  // Started on the first turn that is worth splitting.
+  std::unique_ptr<ThreadPool> m_pool;
+};
+
+} // namespace cube
+
+#endif // PACKED_HXX
@@ -0,0 +1,182 @@
+#include "pocket.hxx"
+#include "lehmer.hxx"
+#include <array>
+#include <bit>
+#include <stdexcept>
+
+using cube::CubieCube;
+using cube::Move;
+
+namespace solver {
+
+// The slots of the seven moving corners, DBL is left out.
+static constexpr std::array<uint8_t, 7> POCKET_CORNERS = {
+    cube::URF, cube::UFL, cube::ULB, cube::UBR,
+    cube::DFR, cube::DLF, cube::DRB};
+
+static constexpr uint64_t LOW_BITS = 0x5555555555555555;
+
+// Bit 2k is set for every entry k of the word holding value.
+static uint64_t entries_equal(uint64_t word, uint8_t value) {
+  uint64_t x = word ^ (LOW_BITS * value);
+  return ~(x | x >> 1) & LOW_BITS;
+}
+
+// Slots are numbered by their position in POCKET_CORNERS.
+static int slot_number(uint8_t corner) {
+  return corner == cube::DRB ? 6 : corner;
+}
+
+static int get_pocket_perm(const CubieCube &cc) {
+  std::array<uint8_t, 7> slots;
+  for (int i = 0; i < 7; i++) {
+    slots[i] = slot_number(cc.corner_perm(POCKET_CORNERS[i]));
+  }
+  return cube::rank_permutation(slots);
+}
+
+static void set_pocket_perm(CubieCube &cc, int rank) {
+  auto slots = cube::unrank_permutation<7>(rank);
+  for (int i = 0; i < 7; i++) {
+    cc.set_corner(POCKET_CORNERS[i], POCKET_CORNERS[slots[i]],
+                  cc.corner_ori(POCKET_CORNERS[i]));
+  }
+}
+
+static int get_pocket_twist(const CubieCube &cc) {
+  int twist = 0;
+  for (int i = 0; i < 6; i++) {
+    twist = 3 * twist + cc.corner_ori(POCKET_CORNERS[i]);
+  }
+  return twist;
+}
+
+static void set_pocket_twist(CubieCube &cc, int twist) {
+  int sum = 0;
+  for (int i = 5; i >= 0; i--) {
+    cc.set_corner(POCKET_CORNERS[i], cc.corner_perm(POCKET_CORNERS[i]),
+                  twist % 3);
+    sum += twist % 3;
+    twist /= 3;
+  }
+  cc.set_corner(cube::DRB, cc.corner_perm(cube::DRB), (3 - sum % 3) % 3);
+}
+
+size_t PocketSolver::index(const CubieCube &cc) {
+  if (cc.corners[cube::DBL] != cube::DBL) {
+    throw std::invalid_argument("The DBL corner has to stay in place!");
+  }
+  return static_cast<size_t>(get_pocket_perm(cc)) * POCKET_TWIST_COUNT +
+         get_pocket_twist(cc);
+}
+
+PocketSolver::PocketSolver()
+    : m_perm_moves(POCKET_PERM_COUNT * POCKET_MOVE_COUNT),
+      m_twist_moves(POCKET_TWIST_COUNT * POCKET_MOVE_COUNT),
+      m_table((POCKET_STATE_COUNT + 31) / 32, ~uint64_t{0}) {
+  for (int perm = 0; perm < POCKET_PERM_COUNT; perm++) {
+    auto cc = CubieCube::solved();
+    set_pocket_perm(cc, perm);
+    for (int m = 0; m < POCKET_MOVE_COUNT; m++) {
+      auto moved = cc;
+      moved.apply(static_cast<Move>(m));
+      m_perm_moves[perm * POCKET_MOVE_COUNT + m] = get_pocket_perm(moved);
+    }
+  }
+  for (int twist = 0; twist < POCKET_TWIST_COUNT; twist++) {
+    auto cc = CubieCube::solved();
+    set_pocket_twist(cc, twist);
+    for (int m = 0; m < POCKET_MOVE_COUNT; m++) {
+      auto moved = cc;
+      moved.apply(static_cast<Move>(m));
+      m_twist_moves[twist * POCKET_MOVE_COUNT + m] = get_pocket_twist(moved);
+    }
+  }
+  fill();
+}
+
+/* NOTE: The remainders cannot tell depth d from d - 3, so going forward also
+ expands a few old entries, which only find known neighbors. Once more than
+ half of the states are known the search goes backwards instead and looks
+ for unknown entries with a neighbor at depth d, which has to be exactly d
+ since no neighbor of an unknown state is closer. */
+void PocketSolver::fill() {
+  set(0, 0);
+  size_t filled = 1;
+  m_distance_counts = {1};
+  for (int depth = 0; filled < POCKET_STATE_COUNT; depth++) {
+    uint8_t current = depth % 3, following = (depth + 1) % 3;
+    bool backwards = filled > POCKET_STATE_COUNT / 2;
+    size_t found = 0;
+    for (size_t w = 0; w < m_table.size(); w++) {
+      for (uint64_t bits = entries_equal(m_table[w],
+                                         backwards ? UNKNOWN : current);
+           bits != 0; bits &= bits - 1) {
+        size_t i = w * 32 + std::countr_zero(bits) / 2;
+        if (i >= POCKET_STATE_COUNT) {
+          break;
+        }
+        for (int m = 0; m < POCKET_MOVE_COUNT; m++) {
+          size_t j = next(i, m);
+          if (backwards) {
+            if (get(j) == current) {
+              set(i, following);
+              found++;
+              break;
+            }
+          } else if (get(j) == UNKNOWN) {
+            set(j, following);
+            found++;
+          }
+        }
+      }
+    }
+    if (found == 0) {
+      throw std::logic_error("Unreachable 2x2x2 states, move tables broken!");
+    }
+    filled += found;
+    m_distance_counts.push_back(found);
+  }
+}
+
+const PocketSolver &PocketSolver::instance() {
+  static PocketSolver solver;
+  return solver;
+}
+
+// The edges do not matter, only the corners have to form a permutation with
+// the twists adding up.
+static bool corners_valid(const CubieCube &cc) {
+  unsigned seen = 0;
+  int twist = 0;
+  for (int i = 0; i < cube::CORNER_COUNT; i++) {
+    seen |= 1u << cc.corner_perm(i);
+    twist += cc.corner_ori(i);
+  }
+  return seen == 0xff && twist % 3 == 0;
+}
+
+std::vector<Move> PocketSolver::solve(const CubieCube &cc) const {
+  if (!corners_valid(cc)) {
+    throw std::invalid_argument("Cannot solve an unreachable cube state!");
+  }
+  std::vector<Move> solution;
+  for (size_t i = index(cc); i != 0;) {
+    uint8_t closer = (get(i) + 2) % 3;
+    for (int m = 0; m < POCKET_MOVE_COUNT; m++) {
+      size_t j = next(i, m);
+      if (get(j) == closer) {
+        solution.push_back(static_cast<Move>(m));
+        i = j;
+        break;
+      }
+    }
+  }
+  return solution;
+}
+
+int PocketSolver::distance(const CubieCube &cc) const {
+  return solve(cc).size();
+}
+
+} // namespace solver
@@ -0,0 +1,80 @@
+#ifndef POCKET_HXX
+#define POCKET_HXX
+#include "cube.hxx"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace solver {
+
+// The 2x2x2 cube is the corners of a 3x3 cube. Keeping DBL in place leaves
+// the other seven corners to U, R and F turns.
+constexpr int POCKET_PERM_COUNT = 5040; // 7!
+constexpr int POCKET_TWIST_COUNT = 729; // 3^6
+constexpr size_t POCKET_STATE_COUNT =
+    static_cast<size_t>(POCKET_PERM_COUNT) * POCKET_TWIST_COUNT; // 3674160
+constexpr int POCKET_MOVE_COUNT = 9; // U1 .. F3
+constexpr int POCKET_MAX_DISTANCE = 11;
+
+/* NOTE: Optimal 2x2x2 solver without any search. The distance of every state
+ is known, stored modulo 3 in two bits so the table takes 900 kB. Each
+ neighbor of a state is one closer, just as far or one further away, which
+ the remainders tell apart, so a solution is walked by always taking a move
+ to the remainder one lower. The table is filled by a breadth first search
+ that scans it 32 entries per word, picking out the entries of the current
+ depth or the unknown ones with a few bit operations. */
+class PocketSolver {
+public:
+  static const PocketSolver &instance();
+
+  // Index of the corners, perm * POCKET_TWIST_COUNT + twist. Throws
+  // std::invalid_argument unless DBL is in place.
+  static size_t index(const cube::CubieCube &cc);
+
+  int distance(const cube::CubieCube &cc) const;
+  // An optimal solution in U, R and F turns. Throws std::invalid_argument
+  // for unreachable corners or DBL out of place.
+  std::vector<cube::Move> solve(const cube::CubieCube &cc) const;
+
+  // Number of states at every distance, found by the search.
+  const std::vector<size_t> &distance_counts() const {
+    return m_distance_counts;
+  }
+
+  PocketSolver(const PocketSolver &other) = delete;
+  PocketSolver &operator=(const PocketSolver &other) = delete;
+
+private:
+  static constexpr uint8_t UNKNOWN = 3;
+
+  PocketSolver();
+
+  uint8_t get(size_t index) const {
+    return (m_table[index / 32] >> (index % 32 * 2)) & 3;
+  }
+
+  void set(size_t index, uint8_t value) {
+    auto &word = m_table[index / 32];
+    auto shift = index % 32 * 2;
+    word = (word & ~(uint64_t{3} << shift)) | (uint64_t{value} << shift);
+  }
+
+  size_t next(size_t index, int move) const {
+    return static_cast<size_t>(
+               m_perm_moves[index / POCKET_TWIST_COUNT * POCKET_MOVE_COUNT +
+                            move]) *
+               POCKET_TWIST_COUNT +
+           m_twist_moves[index % POCKET_TWIST_COUNT * POCKET_MOVE_COUNT + move];
+  }
+
+  void fill();
+
+  std::vector<uint16_t> m_perm_moves;
+  std::vector<uint16_t> m_twist_moves;
+  std::vector<uint64_t> m_table;
+  std::vector<size_t> m_distance_counts;
+};
+
+} // namespace solver
+
+#endif // POCKET_HXX
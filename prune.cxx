@@ -0,0 +1,26 @@
+#include "prune.hxx"
+#include <cstring>
+#include <stdexcept>
+
+namespace solver {
+
+PruningTable::PruningTable(size_t size)
+    : m_size(size), m_heap(byte_size(size), 0xff), m_data(m_heap.data()) {}
+
+PruningTable::PruningTable(size_t size, MappedFile mapping, size_t offset)
+    : m_size(size), m_mapping(std::move(mapping)),
+      m_data(m_mapping->data() + offset) {
+  if (m_mapping->size() < offset + byte_size(size)) {
+    throw std::invalid_argument("Mapping is too small for the pruning table!");
+  }
+}
+
+void PruningTable::clear() { std::memset(m_data, 0xff, byte_size(m_size)); }
+
+void PruningTable::sync() {
+  if (m_mapping) {
+    m_mapping->sync();
+  }
+}
+
+} // namespace solver
@@ -0,0 +1,186 @@
+#ifndef PRUNE_HXX
+#define PRUNE_HXX
+#include "mapped_file.hxx"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace solver {
+
+/* NOTE: Pruning tables store a lower bound on the number of moves needed to
+ solve every coordinate value. The bounds never exceed 14 for the tables we
+ use, so two entries share a byte which halves the memory traffic. The bytes
+ either live on the heap or in a memory mapped file. */
+class PruningTable {
+public:
+  static constexpr uint8_t EMPTY = 0x0f;
+
+  // Heap backed table with every entry EMPTY.
+  explicit PruningTable(size_t size);
+  // Table stored in a mapping, starting offset bytes into it. The entries
+  // are used as they are, call clear() before filling a fresh mapping. A
+  // table in a read only mapping must never be written to.
+  PruningTable(size_t size, MappedFile mapping, size_t offset = 0);
+
+  PruningTable(PruningTable &&other) = default;
+  PruningTable &operator=(PruningTable &&other) = default;
+
+  static constexpr size_t byte_size(size_t size) { return (size + 1) / 2; }
+
+  uint8_t get(size_t index) const {
+    return (m_data[index / 2] >> ((index % 2) * 4)) & 0x0f;
+  }
+
+  // Starts loading the entry into the cache, searches issue this for all
+  // children of a node before reading any of them.
+  void prefetch(size_t index) const {
+#if defined(__GNUC__)
+    __builtin_prefetch(m_data + index / 2);
+#endif
+  }
+
+  void set(size_t index, uint8_t value) {
+    auto &byte = m_data[index / 2];
+    auto shift = (index % 2) * 4;
+    byte = (byte & ~(0x0f << shift)) | (value << shift);
+  }
+
+  // Sets an EMPTY entry with a compare and swap on its byte, so it is safe
+  // while other threads update the neighbouring nibble. Returns false if the
+  // entry was already set.
+  bool set_if_empty(size_t index, uint8_t value) {
+    std::atomic_ref<uint8_t> byte(m_data[index / 2]);
+    auto shift = (index % 2) * 4;
+    uint8_t old = byte.load(std::memory_order_relaxed);
+    uint8_t updated;
+    do {
+      if (((old >> shift) & 0x0f) != EMPTY) {
+        return false;
+      }
+      updated = (old & ~(0x0f << shift)) | (value << shift);
+    } while (!byte.compare_exchange_weak(old, updated,
+                                         std::memory_order_relaxed));
+    return true;
+  }
+
+  // Resets every entry to EMPTY.
+  void clear();
+
+  // Writes a table in a mapping back to its file, see MappedFile::sync().
+  // Heap backed tables have nothing to write.
+  void sync();
+
+  size_t size() const { return m_size; }
+  const uint8_t *data() const { return m_data; }
+
+  /* Breadth first fill from the goal on thread_count threads, 0 uses every
+   core. next(index, move) returns the index reached by a move, or a negative
+   number if the move is not allowed, and must be safe to call from several
+   threads. Each depth is one pass over the table, threads grab chunks of it
+   and claim new entries with set_if_empty. */
+  template <typename Next>
+  void fill_bfs(size_t goal, int move_count, Next next,
+                unsigned thread_count = 0) {
+    fill_bfs(goal, move_count, next, [](size_t, auto &&) {}, thread_count);
+  }
+
+  /* Same for symmetry reduced tables, where a state conjugate to itself has
+   several entries. twins(index, visit) calls visit with the other entries of
+   the state at index, they get filled in together so that every one of them
+   is reached. */
+  template <typename Next, typename Twins>
+  void fill_bfs(size_t goal, int move_count, Next next, Twins twins,
+                unsigned thread_count);
+
+private:
+  static constexpr size_t BFS_CHUNK = 1 << 16;
+
+  uint8_t load(size_t index) {
+    std::atomic_ref<uint8_t> byte(m_data[index / 2]);
+    return (byte.load(std::memory_order_relaxed) >> ((index % 2) * 4)) & 0x0f;
+  }
+
+  size_t m_size;
+  std::vector<uint8_t> m_heap;
+  std::optional<MappedFile> m_mapping;
+  uint8_t *m_data;
+};
+
+template <typename Next, typename Twins>
+void PruningTable::fill_bfs(size_t goal, int move_count, Next next,
+                            Twins twins, unsigned thread_count) {
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  set(goal, 0);
+  size_t filled = 1;
+  twins(goal, [&](size_t j) { filled += set_if_empty(j, 0); });
+  for (uint8_t depth = 0; filled < m_size && depth + 1 < EMPTY; depth++) {
+    // Once most entries are known it is cheaper to look for unknown entries
+    // next to the current depth than to expand the whole frontier. This relies
+    // on the allowed moves being closed under taking inverses.
+    bool backwards = filled > m_size / 2;
+    std::atomic<size_t> next_chunk = 0, new_entries = 0;
+
+    auto worker = [&]() {
+      size_t found = 0;
+      for (;;) {
+        size_t begin = next_chunk.fetch_add(BFS_CHUNK);
+        if (begin >= m_size) {
+          break;
+        }
+        size_t end = std::min(begin + BFS_CHUNK, m_size);
+        for (size_t i = begin; i < end; i++) {
+          if (backwards) {
+            if (load(i) != EMPTY) {
+              continue;
+            }
+            for (int m = 0; m < move_count; m++) {
+              auto j = next(i, m);
+              if (j >= 0 && load(j) == depth) {
+                found += set_if_empty(i, depth + 1);
+                break;
+              }
+            }
+          } else {
+            if (load(i) != depth) {
+              continue;
+            }
+            for (int m = 0; m < move_count; m++) {
+              auto j = next(i, m);
+              if (j >= 0 && set_if_empty(j, depth + 1)) {
+                found++;
+                twins(j,
+                      [&](size_t k) { found += set_if_empty(k, depth + 1); });
+              }
+            }
+          }
+        }
+      }
+      new_entries += found;
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < thread_count; t++) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    if (new_entries == 0) {
+      break;
+    }
+    filled += new_entries;
+  }
+}
+
+} // namespace solver
+
+#endif // PRUNE_HXX
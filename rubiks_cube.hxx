@@ -0,0 +1,400 @@
+#ifndef RUBIKS_CUBE_HXX
+#define RUBIKS_CUBE_HXX
+#include "algorithm.hxx"
+#include "cube.hxx"
+#include "facelet.hxx"
+#include "layer.hxx"
+#include "packed.hxx"
+#include "zobrist.hxx"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace geom {
+struct Ray;
+}
+
+// From this size on stickers are stored packed, see PackedCube.
+constexpr int PACKED_MIN_N = 128;
+
+/* NOTE: The sticker model of an NxN cube, every layer of it can be turned.
+ The 3x3 cube keeps its stickers in a FaceletCube and turns layers with the
+ shuffle kernels, other sizes move stickers along the precomputed layer
+ cycles and huge cubes use packed stickers. Inner layer turns of odd cubes
+ move the centers, the cube counts as solved whenever every face shows a
+ single color. A cube is a plain value, turning it from several threads at
+ once needs a lock, but huge cubes can spread each turn over threads of
+ their own.
+
+ In lazy mode turns only go into a move log and the stickers catch up the
+ next time anything reads them. Turns of one axis commute, so a new turn
+ is merged into the turn of the same layer at the end of the log and the
+ two drop out when they cancel. Readers apply the log, and the 3x3 cube
+ fills its cached cubie state, under a lock of the cube. Const reads are
+ thus safe from several threads at once, say a renderer and picking, and
+ once nothing is pending they only check a flag.
+
+ Cubes up to packed sizes can keep a Zobrist hash of their stickers up to
+ date with every turn, see zobrist.hxx. That costs a walk over the moved
+ stickers per turn, so it is off until set_hashing() turns it on, and
+ hash() computes the hash from the stickers until then. */
+template <int N> class RubiksCube {
+  static_assert(N >= 2, "A cube needs at least two layers!");
+  static constexpr bool PACKED = N >= PACKED_MIN_N;
+
+public:
+  using CellID = int;
+  static constexpr int STICKER_COUNT = cube::STICKER_COUNT<N>;
+
+  RubiksCube() = default;
+
+  // Turns run on thread_count threads, 0 uses every core.
+  explicit RubiksCube(unsigned thread_count)
+    requires(PACKED)
+      : m_stickers(N, thread_count) {}
+
+  // Copying reads the other cube, so it takes the lock of the other cube.
+  RubiksCube(const RubiksCube &other)
+      : RubiksCube(other, std::unique_lock(other.m_flush.mutex)) {}
+
+  RubiksCube &operator=(const RubiksCube &other) {
+    if (this != &other) {
+      std::lock_guard lock(other.m_flush.mutex);
+      m_stickers = other.m_stickers;
+      m_log = other.m_log;
+      m_lazy = other.m_lazy;
+      m_hashing = other.m_hashing;
+      m_hash = other.m_hash;
+      m_state = other.m_state;
+      m_flush = other.m_flush;
+    }
+    return *this;
+  }
+
+  RubiksCube(RubiksCube &&other) = default;
+  RubiksCube &operator=(RubiksCube &&other) = default;
+
+  static constexpr int size() { return N; }
+
+  // Returns negative number if not cell was intersected.
+  CellID ray_intersection(geom::Ray ray) const;
+
+  /* Columns are counted from the left and rows from the top when looking at
+   the front face. Going forward moves the front stickers of a column up and
+   those of a row to the right. */
+  void rotate_column(int column, bool forward) {
+    apply(cube::LayerMove{cube::Face::L, static_cast<uint16_t>(column),
+                          static_cast<uint8_t>(forward ? 3 : 1)});
+  }
+
+  void rotate_row(int row, bool forward) {
+    apply(cube::LayerMove{cube::Face::U, static_cast<uint16_t>(row),
+                          static_cast<uint8_t>(forward ? 3 : 1)});
+  }
+
+  // Turning lazy mode off applies the pending turns.
+  void set_lazy(bool lazy) {
+    if (!lazy) {
+      flush();
+    }
+    m_lazy = lazy;
+  }
+
+  bool is_lazy() const { return m_lazy; }
+
+  // Turns logged but not applied to the stickers yet.
+  size_t pending_moves() const {
+    std::lock_guard lock(m_flush.mutex);
+    return m_log.size();
+  }
+
+  void flush() const {
+    if (!m_flush.pending.load(std::memory_order_acquire)) {
+      return;
+    }
+    std::lock_guard lock(m_flush.mutex);
+    // Another reader may have applied the log while this one waited.
+    if (!m_flush.pending.load(std::memory_order_relaxed)) {
+      return;
+    }
+    for (auto m : m_log) {
+      turn(m);
+    }
+    m_log.clear();
+    m_flush.pending.store(false, std::memory_order_release);
+  }
+
+  void reset() {
+    m_log.clear();
+    m_state.reset();
+    if constexpr (PACKED) {
+      m_stickers.reset();
+    } else {
+      m_stickers = solved_stickers();
+      if (m_hashing) {
+        m_hash = cube::zobrist_hash<N>(stickers());
+      }
+    }
+  }
+
+  // Keeps the hash up to date with every turn from now on.
+  void set_hashing(bool hashing)
+    requires(!PACKED)
+  {
+    flush();
+    if (hashing && !m_hashing) {
+      m_hash = cube::zobrist_hash<N>(stickers());
+    }
+    m_hashing = hashing;
+  }
+
+  bool is_hashing() const { return m_hashing; }
+
+  // Equal cubes hash the same, whatever turns led to them.
+  uint64_t hash() const
+    requires(!PACKED)
+  {
+    flush();
+    return m_hashing ? m_hash : cube::zobrist_hash<N>(stickers());
+  }
+
+  void apply(cube::LayerMove m) {
+    if (m_lazy) {
+      log(m);
+    } else {
+      turn(m);
+    }
+  }
+
+  // Turns the outer layer of a face.
+  void apply(cube::Move m) {
+    if constexpr (N == 3) {
+      if (m_lazy) {
+        log(cube::layer_move(m));
+      } else {
+        if (m_hashing) {
+          m_hash ^= cube::zobrist_delta<N>(stickers(), cube::layer_move(m));
+        }
+        m_stickers.apply(m);
+        if (m_state) {
+          m_state->apply(m);
+        }
+      }
+    } else {
+      apply(cube::layer_move(m));
+    }
+  }
+
+  // A compiled algorithm turns the stickers in one go.
+  void apply(const cube::Algorithm &algorithm)
+    requires(N == 3)
+  {
+    flush();
+    algorithm.apply(m_stickers);
+    if (m_state) {
+      algorithm.apply(*m_state);
+    }
+    if (m_hashing) {
+      m_hash = cube::zobrist_hash<N>(stickers());
+    }
+  }
+
+  template <typename Moves> void apply(const std::vector<Moves> &moves) {
+    for (auto m : moves) {
+      apply(m);
+    }
+  }
+
+  bool is_solved() const {
+    flush();
+    if constexpr (PACKED) {
+      return m_stickers.is_solved();
+    } else {
+      for (int face = 0; face < 6; face++) {
+        for (int i = 1; i < N * N; i++) {
+          if (stickers()[face * N * N + i] != stickers()[face * N * N]) {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+  }
+
+  cube::Face sticker(int index) const {
+    flush();
+    if constexpr (PACKED) {
+      return sticker(static_cast<cube::Face>(index / (N * N)), index / N % N,
+                     index % N);
+    } else {
+      return static_cast<cube::Face>(stickers()[index]);
+    }
+  }
+
+  cube::Face sticker(cube::Face face, int row, int col) const {
+    if constexpr (PACKED) {
+      flush();
+      return static_cast<cube::Face>(
+          m_stickers.get(static_cast<int>(face), row, col));
+    } else {
+      return sticker(static_cast<int>(face) * N * N + row * N + col);
+    }
+  }
+
+  // The facelets relative to the centers, which inner layer turns move
+  // around.
+  cube::FaceletCube facelets() const
+    requires(N == 3)
+  {
+    flush();
+    std::array<uint8_t, 6> face_of_color;
+    for (int face = 0; face < 6; face++) {
+      face_of_color[m_stickers.facelets[face * 9 + 4]] = face;
+    }
+    auto fc = m_stickers;
+    for (int f = 0; f < cube::FACELET_COUNT; f++) {
+      fc.facelets[f] = face_of_color[fc.facelets[f]];
+    }
+    return fc;
+  }
+
+  // Converted from the stickers once and then kept up to date by outer
+  // layer turns.
+  cube::CubieCube state() const
+    requires(N == 3)
+  {
+    flush();
+    std::lock_guard lock(m_flush.mutex);
+    if (!m_state) {
+      // Only reachable stickers can be produced by turning layers.
+      m_state = facelets().to_cubie().value();
+    }
+    return *m_state;
+  }
+
+private:
+  // A long log is applied before it grows without bound.
+  static constexpr size_t MAX_LOG = 1 << 16;
+
+  void turn(cube::LayerMove m) const {
+    if constexpr (!PACKED) {
+      if (m_hashing) {
+        m_hash ^= cube::zobrist_delta<N>(stickers(), m);
+      }
+    }
+    if constexpr (N == 3) {
+      m_stickers.apply(cube::layer_kernel(m));
+      turn_state(m);
+    } else if constexpr (PACKED) {
+      m_stickers.apply(m);
+    } else {
+      cube::apply_layer_move<N>(stickers(), m);
+    }
+  }
+
+  // Outer layers turn the cached state like face moves, turning an inner
+  // layer moves the centers the state is relative to.
+  void turn_state(cube::LayerMove m) const {
+    if (!m_state) {
+      return;
+    }
+    if (m.depth == 0) {
+      m_state->apply(cube::make_move(m.face, m.power));
+    } else if (m.depth == N - 1) {
+      m_state->apply(cube::make_move(cube::opposite(m.face), 4 - m.power));
+    } else {
+      m_state.reset();
+    }
+  }
+
+  // Logs turns around the U, R and F axes, counting layers from those faces.
+  void log(cube::LayerMove m) {
+    m_flush.pending.store(true, std::memory_order_relaxed);
+    int face = static_cast<int>(m.face);
+    if (face >= 3) {
+      m = {static_cast<cube::Face>(face - 3),
+           static_cast<uint16_t>(N - 1 - m.depth),
+           static_cast<uint8_t>(4 - m.power)};
+    }
+    for (auto it = m_log.rbegin(); it != m_log.rend() && it->face == m.face;
+         ++it) {
+      if (it->depth == m.depth) {
+        it->power = (it->power + m.power) % 4;
+        if (it->power == 0) {
+          m_log.erase(std::next(it).base());
+        }
+        return;
+      }
+    }
+    if (m_log.size() == MAX_LOG) {
+      flush();
+    }
+    m_log.push_back(m);
+  }
+
+  // Lets one reader at a time apply the log. Copies get a mutex of their
+  // own.
+  struct FlushLock {
+    std::mutex mutex;
+    std::atomic<bool> pending = false;
+
+    FlushLock() = default;
+    FlushLock(const FlushLock &other) : pending(other.pending.load()) {}
+    FlushLock &operator=(const FlushLock &other) {
+      pending = other.pending.load();
+      return *this;
+    }
+  };
+
+  RubiksCube(const RubiksCube &other, std::unique_lock<std::mutex>)
+      : m_stickers(other.m_stickers), m_log(other.m_log),
+        m_lazy(other.m_lazy), m_hashing(other.m_hashing), m_hash(other.m_hash),
+        m_state(other.m_state), m_flush(other.m_flush) {}
+
+  using Storage = std::conditional_t<
+      N == 3, cube::FaceletCube,
+      std::conditional_t<PACKED, cube::PackedCube,
+                         std::array<uint8_t, STICKER_COUNT>>>;
+
+  uint8_t *stickers() const
+    requires(!PACKED)
+  {
+    if constexpr (N == 3) {
+      return m_stickers.facelets.data();
+    } else {
+      return m_stickers.data();
+    }
+  }
+
+  // Mutable since readers apply the log first.
+  mutable Storage m_stickers = solved_stickers();
+  mutable std::vector<cube::LayerMove> m_log;
+  bool m_lazy = false;
+  bool m_hashing = false;
+  // Only up to date while hashing.
+  mutable uint64_t m_hash = 0;
+  // The 3x3 cubie state, if it was asked for since the last inner layer turn.
+  mutable std::optional<cube::CubieCube> m_state;
+  mutable FlushLock m_flush;
+
+  static Storage solved_stickers() {
+    if constexpr (N == 3) {
+      return cube::FaceletCube::solved();
+    } else if constexpr (PACKED) {
+      return cube::PackedCube(N);
+    } else {
+      Storage stickers{};
+      for (int i = 0; i < STICKER_COUNT; i++) {
+        stickers[i] = i / (N * N);
+      }
+      return stickers;
+    }
+  }
+};
+
+#endif // RUBIKS_CUBE_HXX
@@ -0,0 +1,127 @@
+#include "scramble.hxx"
+#include "thread_pool.hxx"
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using cube::CubieCube;
+using cube::Move;
+
+namespace solver {
+
+// Scrambles per pool task when writing in bulk.
+static constexpr uint64_t SCRAMBLE_BATCH = 64;
+
+// The modulo bias is below 2^-59 for the small ranges used here, unlike the
+// standard distributions the result is the same with every library.
+static int draw(std::mt19937_64 &rng, int n) {
+  return static_cast<int>(rng() % n);
+}
+
+template <size_t N>
+static void shuffle(std::array<uint8_t, N> &values, std::mt19937_64 &rng) {
+  std::iota(values.begin(), values.end(), 0);
+  for (int i = N - 1; i > 0; i--) {
+    std::swap(values[i], values[draw(rng, i + 1)]);
+  }
+}
+
+CubieCube random_state(std::mt19937_64 &rng) {
+  std::array<uint8_t, cube::CORNER_COUNT> cp, co{};
+  std::array<uint8_t, cube::EDGE_COUNT> ep, eo{};
+  shuffle(cp, rng);
+  shuffle(ep, rng);
+
+  int twist = 0, flip = 0;
+  for (int i = 0; i + 1 < cube::CORNER_COUNT; i++) {
+    co[i] = draw(rng, 3);
+    twist += co[i];
+  }
+  co[cube::CORNER_COUNT - 1] = (3 - twist % 3) % 3;
+  for (int i = 0; i + 1 < cube::EDGE_COUNT; i++) {
+    eo[i] = draw(rng, 2);
+    flip += eo[i];
+  }
+  eo[cube::EDGE_COUNT - 1] = flip % 2;
+
+  auto cc = CubieCube::from_arrays(cp, co, ep, eo);
+  // Swapping two edges fixes the parity, every state is still hit by
+  // exactly two permutation pairs.
+  if (cc.corner_parity() != cc.edge_parity()) {
+    std::swap(ep[0], ep[1]);
+    cc = CubieCube::from_arrays(cp, co, ep, eo);
+  }
+  return cc;
+}
+
+Scrambler::Scrambler(uint64_t seed) : m_seed(seed) {}
+
+CubieCube Scrambler::state(uint64_t index) const {
+  std::seed_seq seq{static_cast<uint32_t>(m_seed),
+                    static_cast<uint32_t>(m_seed >> 32),
+                    static_cast<uint32_t>(index),
+                    static_cast<uint32_t>(index >> 32)};
+  std::mt19937_64 rng(seq);
+  for (;;) {
+    auto cc = random_state(rng);
+    // States this close to solved are not fair scrambles.
+    if (!m_solver.solve(cc, 1)) {
+      return cc;
+    }
+  }
+}
+
+std::vector<Move> Scrambler::scramble(uint64_t index) const {
+  auto cc = state(index);
+  std::optional<std::vector<Move>> solution;
+  for (int max_length = TwoPhaseSolver::DEFAULT_MAX_LENGTH; !solution;
+       max_length++) {
+    solution = m_solver.solve(cc, max_length);
+  }
+  std::vector<Move> moves(solution->rbegin(), solution->rend());
+  for (auto &m : moves) {
+    m = cube::inverse(m);
+  }
+  return moves;
+}
+
+/* NOTE: Scrambles are generated in rounds of a few batches per thread and
+ written once the round is done, which keeps them in order with little
+ memory and a short wait for the slowest batch. */
+void Scrambler::write(std::ostream &out, uint64_t first, uint64_t count,
+                      unsigned thread_count) const {
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  ThreadPool pool(thread_count);
+  const uint64_t round_size = 4 * thread_count * SCRAMBLE_BATCH;
+  std::vector<std::string> batches;
+
+  for (uint64_t begin = first; begin < first + count; begin += round_size) {
+    uint64_t end = std::min(begin + round_size, first + count);
+    batches.assign((end - begin + SCRAMBLE_BATCH - 1) / SCRAMBLE_BATCH, {});
+    for (size_t b = 0; b < batches.size(); b++) {
+      pool.submit([&, b]() {
+        uint64_t batch_begin = begin + b * SCRAMBLE_BATCH;
+        uint64_t batch_end = std::min(batch_begin + SCRAMBLE_BATCH, end);
+        for (uint64_t i = batch_begin; i < batch_end; i++) {
+          batches[b] += cube::to_string(scramble(i));
+          batches[b] += '\n';
+        }
+      });
+    }
+    pool.wait();
+
+    for (const auto &batch : batches) {
+      out << batch;
+    }
+    if (!out) {
+      throw std::runtime_error("Could not write the scrambles!");
+    }
+  }
+}
+
+} // namespace solver
@@ -0,0 +1,41 @@
+#ifndef SCRAMBLE_HXX
+#define SCRAMBLE_HXX
+#include "cube.hxx"
+#include "solver.hxx"
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <vector>
+
+namespace solver {
+
+// A uniformly random reachable state: random permutations with matching
+// parities and random orientations with the twist and flip sums fixed.
+cube::CubieCube random_state(std::mt19937_64 &rng);
+
+/* NOTE: Random state scrambles the way the WCA makes them: a uniformly
+ random state, redrawn while it is solved in less than two moves, and the
+ inverse of a two-phase solution for it. Scramble i only depends on the seed
+ and i, so the same seed gives the same scrambles on any machine and however
+ many threads write them. */
+class Scrambler {
+public:
+  explicit Scrambler(uint64_t seed);
+
+  cube::CubieCube state(uint64_t index) const;
+  std::vector<cube::Move> scramble(uint64_t index) const;
+
+  // Writes scrambles first .. first + count - 1 one per line in order,
+  // generating them on thread_count threads, 0 uses every core. Throws
+  // std::runtime_error when the stream fails.
+  void write(std::ostream &out, uint64_t first, uint64_t count,
+             unsigned thread_count = 0) const;
+
+private:
+  uint64_t m_seed;
+  TwoPhaseSolver m_solver;
+};
+
+} // namespace solver
+
+#endif // SCRAMBLE_HXX
@@ -0,0 +1,171 @@
+#include "simplify.hxx"
+#include "canonical.hxx"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+using cube::CubieCube;
+using cube::Move;
+
+namespace solver {
+
+static constexpr int MOVE_BITS = 5;
+static constexpr int LENGTH_SHIFT = MOVE_BITS * SEQUENCE_TABLE_DEPTH;
+
+static uint64_t mix(uint64_t x) {
+  // The splitmix64 finalizer.
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+  return x ^ (x >> 31);
+}
+
+static uint64_t state_hash(const CubieCube &cc) {
+  uint64_t corners, edges_low;
+  uint32_t edges_high;
+  std::memcpy(&corners, cc.corners.data(), sizeof(corners));
+  std::memcpy(&edges_low, cc.edges.data(), sizeof(edges_low));
+  std::memcpy(&edges_high, cc.edges.data() + 8, sizeof(edges_high));
+  return mix(mix(mix(corners) ^ edges_low) ^ edges_high);
+}
+
+SequenceTable::SequenceTable() {
+  std::array<Move, SEQUENCE_TABLE_DEPTH> path;
+  auto visit = [&](auto &self, const CubieCube &cc, uint8_t state,
+                   int depth) -> void {
+    uint32_t packed = static_cast<uint32_t>(depth) << LENGTH_SHIFT;
+    for (int i = 0; i < depth; i++) {
+      packed |= static_cast<uint32_t>(path[i]) << (i * MOVE_BITS);
+    }
+    m_entries.emplace_back(state_hash(cc), packed);
+    if (depth == SEQUENCE_TABLE_DEPTH) {
+      return;
+    }
+    for (auto moves = cube::canonical_moves(state); moves != 0;
+         moves &= moves - 1) {
+      auto m = static_cast<Move>(std::countr_zero(moves));
+      auto next = cc;
+      next.apply(m);
+      path[depth] = m;
+      self(self, next, cube::canonical_next(state, m), depth + 1);
+    }
+  };
+  visit(visit, CubieCube::solved(), cube::CANONICAL_START, 0);
+
+  // Shorter sequences sort first and are the ones kept.
+  std::sort(m_entries.begin(), m_entries.end());
+  m_entries.erase(std::unique(m_entries.begin(), m_entries.end(),
+                              [](const auto &a, const auto &b) {
+                                return a.first == b.first;
+                              }),
+                  m_entries.end());
+  m_entries.shrink_to_fit();
+}
+
+const SequenceTable &SequenceTable::instance() {
+  static SequenceTable table;
+  return table;
+}
+
+std::optional<std::vector<Move>>
+SequenceTable::find(const CubieCube &cc) const {
+  auto hash = state_hash(cc);
+  auto it = std::lower_bound(
+      m_entries.begin(), m_entries.end(), hash,
+      [](const auto &entry, uint64_t h) { return entry.first < h; });
+  if (it == m_entries.end() || it->first != hash) {
+    return {};
+  }
+
+  std::vector<Move> moves(it->second >> LENGTH_SHIFT);
+  auto reached = CubieCube::solved();
+  for (size_t i = 0; i < moves.size(); i++) {
+    moves[i] = static_cast<Move>((it->second >> (i * MOVE_BITS)) &
+                                 ((1 << MOVE_BITS) - 1));
+    reached.apply(moves[i]);
+  }
+  if (reached != cc) {
+    return {};
+  }
+  return moves;
+}
+
+std::optional<std::vector<Move>>
+SequenceTable::shortest(const CubieCube &cc, int max_length) const {
+  if (auto moves = find(cc)) {
+    if (static_cast<int>(moves->size()) <= max_length) {
+      return moves;
+    }
+    return {};
+  }
+  if (max_length <= SEQUENCE_TABLE_DEPTH) {
+    return {};
+  }
+  for (int i = 0; i < cube::MOVE_COUNT; i++) {
+    auto m = static_cast<Move>(i);
+    auto before = cc;
+    before.multiply(cube::move_cube(cube::inverse(m)));
+    if (auto moves = find(before)) {
+      moves->push_back(m);
+      return moves;
+    }
+  }
+  return {};
+}
+
+std::vector<Move> cancel_moves(const std::vector<Move> &moves) {
+  std::vector<Move> result;
+  for (auto m : moves) {
+    auto f = cube::face_of(m);
+    auto opposite = static_cast<cube::Face>((static_cast<int>(f) + 3) % 6);
+    size_t n = result.size();
+    size_t at;
+    if (n >= 1 && cube::face_of(result[n - 1]) == f) {
+      at = n - 1;
+    } else if (n >= 2 && cube::face_of(result[n - 1]) == opposite &&
+               cube::face_of(result[n - 2]) == f) {
+      at = n - 2;
+    } else {
+      result.push_back(m);
+      continue;
+    }
+    int power = (cube::power_of(result[at]) + cube::power_of(m)) % 4;
+    if (power == 0) {
+      result.erase(result.begin() + at);
+    } else {
+      result[at] = cube::make_move(f, power);
+    }
+  }
+  return result;
+}
+
+std::vector<Move> simplify(const std::vector<Move> &moves) {
+  const auto &table = SequenceTable::instance();
+  auto result = cancel_moves(moves);
+  size_t i = 0;
+  while (i < result.size()) {
+    bool replaced = false;
+    int longest = std::min<int>(SIMPLIFY_WINDOW, result.size() - i);
+    for (int length = longest; length >= 2 && !replaced; length--) {
+      auto cc = CubieCube::solved();
+      for (int k = 0; k < length; k++) {
+        cc.apply(result[i + k]);
+      }
+      if (auto shorter = table.shortest(cc, length - 1)) {
+        result.erase(result.begin() + i, result.begin() + i + length);
+        result.insert(result.begin() + i, shorter->begin(), shorter->end());
+        result = cancel_moves(result);
+        replaced = true;
+      }
+    }
+    // A replacement may open up a shorter window starting a bit earlier.
+    if (replaced) {
+      i = i > SIMPLIFY_WINDOW ? i - SIMPLIFY_WINDOW : 0;
+    } else {
+      i++;
+    }
+  }
+  return result;
+}
+
+} // namespace solver
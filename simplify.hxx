@@ -0,0 +1,54 @@
+#ifndef SIMPLIFY_HXX
+#define SIMPLIFY_HXX
+#include "cube.hxx"
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace solver {
+
+// Sequences up to this long are stored in the SequenceTable.
+constexpr int SEQUENCE_TABLE_DEPTH = 5;
+// Longest window simplify() replaces by an optimal sequence.
+constexpr int SIMPLIFY_WINDOW = SEQUENCE_TABLE_DEPTH + 2;
+
+/* NOTE: An optimal sequence for every state at most SEQUENCE_TABLE_DEPTH
+ moves from solved, some 620k of them. They are found by walking the
+ canonical move sequences and kept in a vector sorted by a 64 bit hash of
+ the cubie state. A hash collision can at worst hide a state, every sequence
+ found is checked against the state asked for. */
+class SequenceTable {
+public:
+  static const SequenceTable &instance();
+
+  // An optimal sequence reaching cc from solved, if it takes at most
+  // max_length moves. States one move further than the table are found by
+  // trying every last move.
+  std::optional<std::vector<cube::Move>> shortest(const cube::CubieCube &cc,
+                                                  int max_length) const;
+
+  SequenceTable(const SequenceTable &other) = delete;
+  SequenceTable &operator=(const SequenceTable &other) = delete;
+
+private:
+  SequenceTable();
+
+  std::optional<std::vector<cube::Move>> find(const cube::CubieCube &cc) const;
+
+  // Hash and packed moves: 5 bits per move, the length in the top bits.
+  std::vector<std::pair<uint64_t, uint32_t>> m_entries;
+};
+
+// Merges turns of the same face that follow each other, also across a turn
+// of the opposite face, and drops the ones that cancel out.
+std::vector<cube::Move> cancel_moves(const std::vector<cube::Move> &moves);
+
+// Cancels moves and replaces every window of up to SIMPLIFY_WINDOW moves
+// with an optimal one, until nothing gets shorter. The result reaches the
+// same state as the moves given.
+std::vector<cube::Move> simplify(const std::vector<cube::Move> &moves);
+
+} // namespace solver
+
+#endif // SIMPLIFY_HXX
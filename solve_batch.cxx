@@ -0,0 +1,57 @@
+#include "batch.hxx"
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Solves cube states read one per line from a file, or from stdin when the
+// file is "-" or missing, and writes one solution per line to stdout.
+int main(int argc, char **argv) {
+  // The whole thread count must be a number, 0 for all the cores.
+  unsigned thread_count = 0;
+  bool valid = argc <= 4;
+  if (argc == 4) {
+    const char *end = argv[3] + std::strlen(argv[3]);
+    auto [ptr, ec] = std::from_chars(argv[3], end, thread_count);
+    valid = ec == std::errc() && ptr == end;
+  }
+  if (!valid) {
+    std::cerr << "Usage: " << argv[0]
+              << " [input-file] [fast|optimal] [thread-count]\n";
+    return 1;
+  }
+
+  std::string path = argc >= 2 ? argv[1] : "-";
+  std::string mode = argc >= 3 ? argv[2] : "fast";
+  if (mode != "fast" && mode != "optimal") {
+    std::cerr << "Unknown mode " << mode << "\n";
+    return 1;
+  }
+
+  std::ifstream file;
+  if (path != "-") {
+    file.open(path);
+    if (!file) {
+      std::cerr << "Could not open " << path << "\n";
+      return 1;
+    }
+  }
+  std::istream &in = path == "-" ? std::cin : file;
+
+  // Not synchronized with stdio, the streams are much faster.
+  std::ios::sync_with_stdio(false);
+  try {
+    solver::BatchSolver solver(mode == "optimal" ? solver::SolveMode::OPTIMAL
+                                                 : solver::SolveMode::FAST,
+                               thread_count);
+    if (uint64_t failed = solver.solve(in, std::cout)) {
+      std::cerr << failed << " lines could not be solved\n";
+      return 1;
+    }
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  return 0;
+}
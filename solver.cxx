@@ -0,0 +1,231 @@
+#include "solver.hxx"
+#include "canonical.hxx"
+#include "optimal.hxx"
+#include "tables.hxx"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+
+using cube::CORNERS_COUNT;
+using cube::Move;
+using cube::MOVE_COUNT;
+using cube::SLICE_PERM_COUNT;
+
+namespace solver {
+
+static constexpr int MAX_SEARCH_DEPTH = 32;
+
+// Anytime searches look at the clock once every this many nodes plus one.
+static constexpr uint32_t DEADLINE_CHECK_MASK = 1023;
+
+static constexpr uint32_t PHASE2_MOVES = [] {
+  uint32_t mask = 0;
+  for (int m = 0; m < MOVE_COUNT; m++) {
+    if (cube::is_phase2_move(static_cast<Move>(m))) {
+      mask |= uint32_t{1} << m;
+    }
+  }
+  return mask;
+}();
+
+TwoPhaseTables::TwoPhaseTables()
+    : flipslice_twist(open_table(TableKind::FLIPSLICE_TWIST)),
+      slice_corners(open_table(TableKind::SLICE_CORNERS)),
+      slice_ud_edges(open_table(TableKind::SLICE_UD_EDGES)) {}
+
+const TwoPhaseTables &TwoPhaseTables::instance() {
+  static TwoPhaseTables tables;
+  return tables;
+}
+
+namespace {
+
+struct Search {
+  const cube::MoveTables &mt;
+  const cube::SymmetryTables &st;
+  const TwoPhaseTables &pt;
+  cube::CubieCube start;
+  int max_length;
+  std::array<Move, MAX_SEARCH_DEPTH> path{};
+  std::optional<std::vector<Move>> result{};
+  // Anytime searches go on after a solution, looking for shorter ones until
+  // the deadline.
+  std::optional<TwoPhaseSolver::Clock::time_point> deadline{};
+  const TwoPhaseSolver::Improvement *on_improvement = nullptr;
+  bool expired = false;
+  uint32_t nodes = 0;
+
+  // Reading the clock is slow, it is only checked every few nodes.
+  bool out_of_time() {
+    if (deadline && (++nodes & DEADLINE_CHECK_MASK) == 0 &&
+        TwoPhaseSolver::Clock::now() >= *deadline) {
+      expired = true;
+    }
+    return expired;
+  }
+
+  // Searches phase 1 solutions of increasing length, the first solution
+  // ends the search unless it is an anytime one.
+  void run() {
+    int twist = cube::get_twist(start);
+    int flip = cube::get_flip(start);
+    int slice_sorted = cube::get_slice_sorted(start);
+    for (int depth1 =
+             phase1_bound(twist, flip, slice_sorted / SLICE_PERM_COUNT);
+         depth1 <= max_length; depth1++) {
+      if (phase1(twist, flip, slice_sorted, 0, depth1)) {
+        break;
+      }
+    }
+  }
+
+  int phase1_bound(int twist, int flip, int slice) const {
+    return pt.flipslice_twist.get(st.flipslice_twist_index(slice, flip, twist));
+  }
+
+  // The canonical moves that may follow the path so far.
+  uint32_t allowed_moves(int depth) const {
+    return cube::canonical_moves(
+        depth > 0 ? cube::canonical_state_after(path[depth - 1])
+                  : cube::CANONICAL_START);
+  }
+
+  int phase2_bound(int corners, int ud_edges, int slice_sorted) const {
+    return std::max(
+        pt.slice_corners.get(slice_sorted * CORNERS_COUNT + corners),
+        pt.slice_ud_edges.get(slice_sorted * cube::UD_EDGES_COUNT + ud_edges));
+  }
+
+  bool phase1(int twist, int flip, int slice_sorted, int depth, int togo) {
+    if (out_of_time()) {
+      return true;
+    }
+    if (togo == 0) {
+      return start_phase2(depth);
+    }
+    for (auto moves = allowed_moves(depth); moves != 0; moves &= moves - 1) {
+      int i = std::countr_zero(moves);
+      auto m = static_cast<Move>(i);
+      int ntwist = mt.twist[twist * MOVE_COUNT + i];
+      int nflip = mt.flip[flip * MOVE_COUNT + i];
+      int nslice = mt.slice_sorted[slice_sorted * MOVE_COUNT + i];
+      int bound = phase1_bound(ntwist, nflip, nslice / SLICE_PERM_COUNT);
+      if (bound >= togo) {
+        continue;
+      }
+      // A phase 1 solution ending in a phase 2 move was already tried as a
+      // shorter phase 1 solution.
+      if (togo == 1 && cube::is_phase2_move(m)) {
+        continue;
+      }
+      path[depth] = m;
+      if (phase1(ntwist, nflip, nslice, depth + 1, togo - 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool start_phase2(int depth1) {
+    auto cc = start;
+    for (int i = 0; i < depth1; i++) {
+      cc.apply(path[i]);
+    }
+    int corners = cube::get_corners(cc);
+    int ud_edges = cube::get_ud_edges(cc);
+    int slice_sorted = cube::get_slice_sorted(cc);
+
+    for (int depth2 = phase2_bound(corners, ud_edges, slice_sorted);
+         depth2 <= max_length - depth1; depth2++) {
+      if (phase2(corners, ud_edges, slice_sorted, depth1, depth2)) {
+        if (expired) {
+          return true;
+        }
+        result = std::vector<Move>(path.begin(), path.begin() + depth1 + depth2);
+        if (!deadline) {
+          return true;
+        }
+        if (*on_improvement) {
+          (*on_improvement)(*result);
+        }
+        // Only shorter solutions are of interest from now on. Once the phase
+        // 1 length is over the new limit no other path of this length can
+        // give one, and the loop in run() stops at the limit too.
+        max_length = depth1 + depth2 - 1;
+        return depth1 > max_length;
+      }
+    }
+    return false;
+  }
+
+  bool phase2(int corners, int ud_edges, int slice_sorted, int depth,
+              int togo) {
+    if (out_of_time()) {
+      return true;
+    }
+    if (togo == 0) {
+      return corners == 0 && ud_edges == 0 && slice_sorted == 0;
+    }
+    for (auto moves = allowed_moves(depth) & PHASE2_MOVES; moves != 0;
+         moves &= moves - 1) {
+      int i = std::countr_zero(moves);
+      auto m = static_cast<Move>(i);
+      int ncorners = mt.corners[corners * MOVE_COUNT + i];
+      int nud_edges = mt.ud_edges[ud_edges * MOVE_COUNT + i];
+      int nslice = mt.slice_sorted[slice_sorted * MOVE_COUNT + i];
+      if (phase2_bound(ncorners, nud_edges, nslice) >= togo) {
+        continue;
+      }
+      path[depth] = m;
+      if (phase2(ncorners, nud_edges, nslice, depth + 1, togo - 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+} // namespace
+
+TwoPhaseSolver::TwoPhaseSolver()
+    : m_moves(cube::MoveTables::instance()),
+      m_symmetries(cube::SymmetryTables::instance()),
+      m_tables(TwoPhaseTables::instance()) {}
+
+std::optional<std::vector<Move>>
+TwoPhaseSolver::solve(const cube::CubieCube &cc, int max_length) const {
+  if (!cc.is_valid()) {
+    throw std::invalid_argument("Cannot solve an unreachable cube state!");
+  }
+  max_length = std::min(max_length, MAX_SEARCH_DEPTH);
+
+  Search search{m_moves, m_symmetries, m_tables, cc, max_length};
+  search.run();
+  return search.result;
+}
+
+std::optional<std::vector<Move>>
+TwoPhaseSolver::solve(const cube::CubieCube &cc, Clock::time_point deadline,
+                      const Improvement &on_improvement) const {
+  if (!cc.is_valid()) {
+    throw std::invalid_argument("Cannot solve an unreachable cube state!");
+  }
+
+  Search search{m_moves, m_symmetries, m_tables, cc, MAX_SEARCH_DEPTH};
+  search.deadline = deadline;
+  search.on_improvement = &on_improvement;
+  search.run();
+  return search.result;
+}
+
+std::vector<Move> solve(const cube::CubieCube &cc, SolveMode mode) {
+  if (mode == SolveMode::OPTIMAL) {
+    return OptimalSolver().solve(cc);
+  }
+  // Every cube is at most 20 moves from solved and the search is complete,
+  // so a 21 move limit always finds something.
+  return TwoPhaseSolver().solve(cc).value();
+}
+
+} // namespace solver
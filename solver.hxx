@@ -0,0 +1,78 @@
+#ifndef SOLVER_HXX
+#define SOLVER_HXX
+#include "coord.hxx"
+#include "cube.hxx"
+#include "prune.hxx"
+#include "symmetry.hxx"
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace solver {
+
+// Pruning tables of the two-phase solver. Phase 1 knows the exact distance to
+// <U, D, R2, L2, F2, B2> of every (flip slice class, twist), phase 2 bounds
+// the distance to solved from (slice order, corners) and (slice order, U/D
+// edges).
+class TwoPhaseTables {
+public:
+  static const TwoPhaseTables &instance();
+
+  PruningTable flipslice_twist;
+  PruningTable slice_corners;
+  PruningTable slice_ud_edges;
+
+  TwoPhaseTables(const TwoPhaseTables &other) = delete;
+  TwoPhaseTables &operator=(const TwoPhaseTables &other) = delete;
+
+private:
+  TwoPhaseTables();
+};
+
+/* NOTE: Kociemba's two-phase algorithm. Phase 1 searches for move sequences
+ that bring the cube into <U, D, R2, L2, F2, B2>, every phase 1 solution is
+ then completed by a phase 2 search within that subgroup. Phase 1 solutions
+ are tried in order of increasing length until the whole solution fits in
+ max_length moves. solve() only reads the shared tables, so one solver can be
+ used from several threads. */
+class TwoPhaseSolver {
+public:
+  static constexpr int DEFAULT_MAX_LENGTH = 21;
+
+  TwoPhaseSolver();
+
+  using Clock = std::chrono::steady_clock;
+  // Called with every solution shorter than the ones before.
+  using Improvement = std::function<void(const std::vector<cube::Move> &)>;
+
+  // Throws std::invalid_argument for unreachable cubes. Returns nothing if no
+  // solution of at most max_length moves was found.
+  std::optional<std::vector<cube::Move>>
+  solve(const cube::CubieCube &cc, int max_length = DEFAULT_MAX_LENGTH) const;
+
+  /* Anytime solving: keeps looking for shorter solutions after the first
+   one until the deadline passes, and returns the shortest one found. That
+   is nothing if the deadline passed before the first solution, a return
+   before the deadline means the solution is optimal. Throws
+   std::invalid_argument for unreachable cubes. */
+  std::optional<std::vector<cube::Move>>
+  solve(const cube::CubieCube &cc, Clock::time_point deadline,
+        const Improvement &on_improvement = {}) const;
+
+private:
+  const cube::MoveTables &m_moves;
+  const cube::SymmetryTables &m_symmetries;
+  const TwoPhaseTables &m_tables;
+};
+
+enum struct SolveMode { FAST, OPTIMAL };
+
+// Solves with the two-phase solver in FAST mode and with the optimal solver
+// in OPTIMAL mode. Throws std::invalid_argument for unreachable cubes.
+std::vector<cube::Move> solve(const cube::CubieCube &cc,
+                              SolveMode mode = SolveMode::FAST);
+
+} // namespace solver
+
+#endif // SOLVER_HXX
@@ -0,0 +1,219 @@
+#include "symmetry.hxx"
+#include <array>
+
+namespace cube {
+
+namespace {
+
+/* NOTE: Reflections can not be written as a CubieCube: a reflected corner
+ keeps its place in the orientation order but reads it backwards, which
+ Kociemba encodes as orientations 3 to 5. Only the symmetries themselves
+ carry those, conjugating a real cube with them gives a real cube again. */
+struct SymCube {
+  std::array<uint8_t, CORNER_COUNT> cp, co;
+  std::array<uint8_t, EDGE_COUNT> ep, eo;
+
+  static SymCube from_cubie(const CubieCube &cc) {
+    SymCube sc;
+    for (int i = 0; i < CORNER_COUNT; i++) {
+      sc.cp[i] = cc.corner_perm(i);
+      sc.co[i] = cc.corner_ori(i);
+    }
+    for (int i = 0; i < EDGE_COUNT; i++) {
+      sc.ep[i] = cc.edge_perm(i);
+      sc.eo[i] = cc.edge_ori(i);
+    }
+    return sc;
+  }
+
+  CubieCube to_cubie() const {
+    CubieCube cc{};
+    for (int i = 0; i < CORNER_COUNT; i++) {
+      cc.set_corner(i, cp[i], co[i]);
+    }
+    for (int i = 0; i < EDGE_COUNT; i++) {
+      cc.set_edge(i, ep[i], eo[i]);
+    }
+    return cc;
+  }
+
+  SymCube operator*(const SymCube &b) const {
+    SymCube r;
+    for (int i = 0; i < CORNER_COUNT; i++) {
+      int oa = co[b.cp[i]], ob = b.co[i], ori;
+      if (oa < 3 && ob < 3) {
+        ori = (oa + ob) % 3;
+      } else if (oa < 3) {
+        ori = oa + ob >= 6 ? oa + ob - 3 : oa + ob;
+      } else if (ob < 3) {
+        ori = oa - ob < 3 ? oa - ob + 3 : oa - ob;
+      } else {
+        ori = oa - ob < 0 ? oa - ob + 3 : oa - ob;
+      }
+      r.cp[i] = cp[b.cp[i]];
+      r.co[i] = ori;
+    }
+    for (int i = 0; i < EDGE_COUNT; i++) {
+      r.ep[i] = ep[b.ep[i]];
+      r.eo[i] = eo[b.ep[i]] ^ b.eo[i];
+    }
+    return r;
+  }
+
+  SymCube inverse() const {
+    SymCube r;
+    for (int i = 0; i < CORNER_COUNT; i++) {
+      r.cp[cp[i]] = i;
+      r.co[cp[i]] = co[i] >= 3 ? co[i] : (3 - co[i]) % 3;
+    }
+    for (int i = 0; i < EDGE_COUNT; i++) {
+      r.ep[ep[i]] = i;
+      r.eo[ep[i]] = eo[i];
+    }
+    return r;
+  }
+};
+
+// clang-format off
+const SymCube ROT_URF3 = {
+    {URF, DFR, DLF, UFL, UBR, DRB, DBL, ULB}, {1, 2, 1, 2, 2, 1, 2, 1},
+    {UF, FR, DF, FL, UB, BR, DB, BL, UR, DR, DL, UL},
+    {1, 0, 1, 0, 1, 0, 1, 0, 1, 1, 1, 1}};
+const SymCube ROT_F2 = {
+    {DLF, DFR, DRB, DBL, UFL, URF, UBR, ULB}, {0, 0, 0, 0, 0, 0, 0, 0},
+    {DL, DF, DR, DB, UL, UF, UR, UB, FL, FR, BR, BL},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
+const SymCube ROT_U4 = {
+    {UBR, URF, UFL, ULB, DRB, DFR, DLF, DBL}, {0, 0, 0, 0, 0, 0, 0, 0},
+    {UB, UR, UF, UL, DB, DR, DF, DL, BR, FR, FL, BL},
+    {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1}};
+const SymCube MIRR_LR2 = {
+    {UFL, URF, UBR, ULB, DLF, DFR, DRB, DBL}, {3, 3, 3, 3, 3, 3, 3, 3},
+    {UL, UF, UR, UB, DL, DF, DR, DB, FL, FR, BR, BL},
+    {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}};
+// clang-format on
+
+struct Symmetries {
+  std::array<SymCube, SYM_COUNT> cubes;
+  std::array<SymCube, SYM_COUNT> inverses;
+  std::array<int, SYM_COUNT> inverse_index;
+
+  Symmetries() {
+    auto cc = SymCube::from_cubie(CubieCube::solved());
+    int s = 0;
+    for (int urf3 = 0; urf3 < 3; urf3++) {
+      for (int f2 = 0; f2 < 2; f2++) {
+        for (int u4 = 0; u4 < 4; u4++) {
+          for (int lr2 = 0; lr2 < 2; lr2++) {
+            cubes[s] = cc;
+            inverses[s++] = cc.inverse();
+            cc = cc * MIRR_LR2;
+          }
+          cc = cc * ROT_U4;
+        }
+        cc = cc * ROT_F2;
+      }
+      cc = cc * ROT_URF3;
+    }
+
+    auto solved = CubieCube::solved();
+    for (int i = 0; i < SYM_COUNT; i++) {
+      for (int j = 0; j < SYM_COUNT; j++) {
+        if ((cubes[i] * cubes[j]).to_cubie() == solved) {
+          inverse_index[i] = j;
+        }
+      }
+    }
+  }
+};
+
+const Symmetries &symmetries() {
+  static Symmetries syms;
+  return syms;
+}
+
+} // namespace
+
+CubieCube conjugate(const CubieCube &cc, int s) {
+  const auto &syms = symmetries();
+  return (syms.cubes[s] * SymCube::from_cubie(cc) * syms.inverses[s])
+      .to_cubie();
+}
+
+int inverse_symmetry(int s) { return symmetries().inverse_index[s]; }
+
+SymmetryTables::SymmetryTables()
+    : twist_conj(TWIST_COUNT * UD_SYM_COUNT),
+      flipslice_class(FLIPSLICE_COUNT, UINT32_MAX),
+      corners_class(CORNERS_COUNT, UINT16_MAX) {
+  for (int twist = 0; twist < TWIST_COUNT; twist++) {
+    auto cc = CubieCube::solved();
+    set_twist(cc, twist);
+    for (int s = 0; s < UD_SYM_COUNT; s++) {
+      twist_conj[twist * UD_SYM_COUNT + s] = get_twist(conjugate(cc, s));
+    }
+  }
+
+  // Walking the states in order makes the first member of every class its
+  // smallest one.
+  flipslice_rep.reserve(FLIPSLICE_CLASS_COUNT);
+  flipslice_stabilizer.reserve(FLIPSLICE_CLASS_COUNT);
+  for (int slice = 0; slice < SLICE_COUNT; slice++) {
+    auto cc = CubieCube::solved();
+    set_slice_sorted(cc, slice * SLICE_PERM_COUNT);
+    for (int flip = 0; flip < FLIP_COUNT; flip++) {
+      uint32_t rep = slice * FLIP_COUNT + flip;
+      if (flipslice_class[rep] != UINT32_MAX) {
+        continue;
+      }
+      set_flip(cc, flip);
+      uint32_t cls = flipslice_rep.size();
+      uint16_t stabilizer = 0;
+      for (int s = 0; s < UD_SYM_COUNT; s++) {
+        auto conj = conjugate(cc, s);
+        uint32_t state =
+            get_slice_sorted(conj) / SLICE_PERM_COUNT * FLIP_COUNT +
+            get_flip(conj);
+        if (state == rep) {
+          stabilizer |= 1 << s;
+        }
+        // The inverse of s takes the conjugate back to the representative.
+        if (flipslice_class[state] == UINT32_MAX) {
+          flipslice_class[state] = cls << 4 | inverse_symmetry(s);
+        }
+      }
+      flipslice_rep.push_back(rep);
+      flipslice_stabilizer.push_back(stabilizer);
+    }
+  }
+
+  corners_rep.reserve(CORNERS_CLASS_COUNT);
+  corners_stabilizer.reserve(CORNERS_CLASS_COUNT);
+  for (int rep = 0; rep < CORNERS_COUNT; rep++) {
+    if (corners_class[rep] != UINT16_MAX) {
+      continue;
+    }
+    auto cc = CubieCube::solved();
+    set_corners(cc, rep);
+    uint16_t cls = corners_rep.size();
+    uint16_t stabilizer = 0;
+    for (int s = 0; s < UD_SYM_COUNT; s++) {
+      int corners = get_corners(conjugate(cc, s));
+      if (corners == rep) {
+        stabilizer |= 1 << s;
+      }
+      if (corners_class[corners] == UINT16_MAX) {
+        corners_class[corners] = cls << 4 | inverse_symmetry(s);
+      }
+    }
+    corners_rep.push_back(rep);
+    corners_stabilizer.push_back(stabilizer);
+  }
+}
+
+const SymmetryTables &SymmetryTables::instance() {
+  static SymmetryTables tables;
+  return tables;
+}
+
+} // namespace cube
@@ -0,0 +1,82 @@
+#ifndef SYMMETRY_HXX
+#define SYMMETRY_HXX
+#include "coord.hxx"
+#include "cube.hxx"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cube {
+
+/* NOTE: The 48 symmetries of the cube are numbered
+ 16 * urf3 + 8 * f2 + 2 * u4 + lr2, the powers of a rotation around the URF-DBL
+ diagonal, a half turn around the F-B axis, a quarter turn around the U-D axis
+ and the reflection swapping left and right. The first 16 keep the U-D axis in
+ place, so they map phase 1 of the two-phase solver onto itself and cubes
+ conjugate under them are the same distance away from <U, D, R2, L2, F2, B2>.
+ Odd symmetries are reflections. */
+constexpr int SYM_COUNT = 48;
+constexpr int UD_SYM_COUNT = 16;
+
+constexpr int FLIPSLICE_COUNT = SLICE_COUNT * FLIP_COUNT; // 1013760
+constexpr int FLIPSLICE_CLASS_COUNT = 64430;
+constexpr size_t FLIPSLICE_TWIST_COUNT =
+    static_cast<size_t>(FLIPSLICE_CLASS_COUNT) * TWIST_COUNT; // 140908410
+constexpr int CORNERS_CLASS_COUNT = 2768;
+constexpr size_t CORNERS_TWIST_COUNT =
+    static_cast<size_t>(CORNERS_CLASS_COUNT) * TWIST_COUNT; // 6053616
+
+// S * cc * S^-1 for the symmetry S numbered s.
+CubieCube conjugate(const CubieCube &cc, int s);
+int inverse_symmetry(int s);
+
+/* NOTE: The phase 1 edge state, slice * FLIP_COUNT + flip, is reduced to one
+ of FLIPSLICE_CLASS_COUNT classes of states conjugate under the UD
+ symmetries. Each class is stored as its smallest member, the representative,
+ together with the symmetries that map the class onto itself. The corner
+ permutation is reduced the same way for the corner pattern database of the
+ optimal solver. Under the UD symmetries the conjugate twist depends on the
+ twist alone, so both tables pair a class with the twist of the state
+ conjugated onto the representative. */
+class SymmetryTables {
+public:
+  static const SymmetryTables &instance();
+
+  // Twist of the conjugate under a UD symmetry, twist * UD_SYM_COUNT + s.
+  std::vector<uint16_t> twist_conj;
+  // class << 4 | s for every flip slice state, where conjugating the state
+  // with s gives the representative of the class.
+  std::vector<uint32_t> flipslice_class;
+  std::vector<uint32_t> flipslice_rep;
+  // Bit s is set when s maps the representative onto itself.
+  std::vector<uint16_t> flipslice_stabilizer;
+
+  // class << 4 | s for every corner permutation, as for flip slice states.
+  std::vector<uint16_t> corners_class;
+  std::vector<uint16_t> corners_rep;
+  std::vector<uint16_t> corners_stabilizer;
+
+  // Index of a phase 1 state in tables over flip slice classes and twists.
+  size_t flipslice_twist_index(int slice, int flip, int twist) const {
+    auto packed = flipslice_class[slice * FLIP_COUNT + flip];
+    return static_cast<size_t>(packed >> 4) * TWIST_COUNT +
+           twist_conj[twist * UD_SYM_COUNT + (packed & 0xf)];
+  }
+
+  // Index of a corner state in tables over corner classes and twists.
+  size_t corners_twist_index(int corners, int twist) const {
+    auto packed = corners_class[corners];
+    return static_cast<size_t>(packed >> 4) * TWIST_COUNT +
+           twist_conj[twist * UD_SYM_COUNT + (packed & 0xf)];
+  }
+
+  SymmetryTables(const SymmetryTables &other) = delete;
+  SymmetryTables &operator=(const SymmetryTables &other) = delete;
+
+private:
+  SymmetryTables();
+};
+
+} // namespace cube
+
+#endif // SYMMETRY_HXX
@@ -0,0 +1,319 @@
+#include "tables.hxx"
+#include "coord.hxx"
+#include "optimal.hxx"
+#include "symmetry.hxx"
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+using cube::CORNERS_COUNT;
+using cube::FLIP_COUNT;
+using cube::Move;
+using cube::MOVE_COUNT;
+using cube::SLICE_PERM_COUNT;
+using cube::TWIST_COUNT;
+using cube::UD_EDGES_COUNT;
+using cube::UD_SYM_COUNT;
+
+namespace solver {
+
+const char *table_name(TableKind kind) {
+  switch (kind) {
+  case TableKind::FLIPSLICE_TWIST:
+    return "flipslice_twist";
+  case TableKind::SLICE_CORNERS:
+    return "slice_corners";
+  case TableKind::SLICE_UD_EDGES:
+    return "slice_ud_edges";
+  case TableKind::CORNERS:
+    return "corners";
+  case TableKind::EDGES_LOW:
+    return "edges_low";
+  case TableKind::EDGES_HIGH:
+    return "edges_high";
+  default:
+    throw std::invalid_argument("Unknown table kind: " +
+                                std::to_string(static_cast<uint32_t>(kind)));
+  }
+}
+
+size_t table_entry_count(TableKind kind) {
+  switch (kind) {
+  case TableKind::FLIPSLICE_TWIST:
+    return cube::FLIPSLICE_TWIST_COUNT;
+  case TableKind::SLICE_CORNERS:
+    return SLICE_PERM_COUNT * CORNERS_COUNT;
+  case TableKind::SLICE_UD_EDGES:
+    return SLICE_PERM_COUNT * UD_EDGES_COUNT;
+  case TableKind::CORNERS:
+    return cube::CORNERS_TWIST_COUNT;
+  case TableKind::EDGES_LOW:
+  case TableKind::EDGES_HIGH:
+    return EDGE_GROUP_STATE_COUNT;
+  default:
+    throw std::invalid_argument("Unknown table kind: " +
+                                std::to_string(static_cast<uint32_t>(kind)));
+  }
+}
+
+static void fill_table(TableKind kind, PruningTable &table,
+                       unsigned thread_count) {
+  const auto &mt = cube::MoveTables::instance();
+
+  // The slice move table works on sorted slices, any representative of a
+  // slice position moves to the same position.
+  auto move_slice = [&mt](size_t slice, int m) -> size_t {
+    return mt.slice_sorted[slice * SLICE_PERM_COUNT * MOVE_COUNT + m] /
+           SLICE_PERM_COUNT;
+  };
+
+  auto phase2_next = [&mt](const std::vector<uint16_t> &coord_table,
+                           int count) {
+    return [&mt, &coord_table, count](size_t i, int m) -> long {
+      if (!cube::is_phase2_move(static_cast<Move>(m))) {
+        return -1;
+      }
+      auto slice = i / count, coord = i % count;
+      return static_cast<long>(mt.slice_sorted[slice * MOVE_COUNT + m]) *
+                 count +
+             coord_table[coord * MOVE_COUNT + m];
+    };
+  };
+
+  auto edge_group_next = [](int first) {
+    return [first](size_t i, int m) -> long {
+      EdgeLocations locations = {0};
+      set_edge_group(locations, first, i);
+      move_edge_locations(locations, static_cast<Move>(m));
+      return edge_group_index(locations, first);
+    };
+  };
+
+  auto solved_edges = edge_locations(cube::CubieCube::solved());
+
+  switch (kind) {
+  case TableKind::FLIPSLICE_TWIST: {
+    // Entries are (flip slice class, twist) pairs, moves are applied to the
+    // representative of the class.
+    const auto &st = cube::SymmetryTables::instance();
+    table.fill_bfs(
+        0, MOVE_COUNT,
+        [&](size_t i, int m) -> long {
+          auto rep = st.flipslice_rep[i / TWIST_COUNT];
+          auto twist = i % TWIST_COUNT;
+          return st.flipslice_twist_index(
+              move_slice(rep / FLIP_COUNT, m),
+              mt.flip[rep % FLIP_COUNT * MOVE_COUNT + m],
+              mt.twist[twist * MOVE_COUNT + m]);
+        },
+        [&](size_t i, auto &&visit) {
+          auto cls = i / TWIST_COUNT, twist = i % TWIST_COUNT;
+          auto stabilizer = st.flipslice_stabilizer[cls];
+          for (int s = 1; s < UD_SYM_COUNT; s++) {
+            if (stabilizer & (1 << s)) {
+              visit(cls * TWIST_COUNT +
+                    st.twist_conj[twist * UD_SYM_COUNT + s]);
+            }
+          }
+        },
+        thread_count);
+    break;
+  }
+  case TableKind::SLICE_CORNERS:
+    table.fill_bfs(0, MOVE_COUNT, phase2_next(mt.corners, CORNERS_COUNT),
+                   thread_count);
+    break;
+  case TableKind::SLICE_UD_EDGES:
+    table.fill_bfs(0, MOVE_COUNT, phase2_next(mt.ud_edges, UD_EDGES_COUNT),
+                   thread_count);
+    break;
+  case TableKind::CORNERS: {
+    // Entries are (corners class, twist) pairs like the phase 1 table.
+    const auto &st = cube::SymmetryTables::instance();
+    table.fill_bfs(
+        0, MOVE_COUNT,
+        [&](size_t i, int m) -> long {
+          auto rep = st.corners_rep[i / TWIST_COUNT];
+          auto twist = i % TWIST_COUNT;
+          return st.corners_twist_index(mt.corners[rep * MOVE_COUNT + m],
+                                        mt.twist[twist * MOVE_COUNT + m]);
+        },
+        [&](size_t i, auto &&visit) {
+          auto cls = i / TWIST_COUNT, twist = i % TWIST_COUNT;
+          auto stabilizer = st.corners_stabilizer[cls];
+          for (int s = 1; s < UD_SYM_COUNT; s++) {
+            if (stabilizer & (1 << s)) {
+              visit(cls * TWIST_COUNT +
+                    st.twist_conj[twist * UD_SYM_COUNT + s]);
+            }
+          }
+        },
+        thread_count);
+    break;
+  }
+  case TableKind::EDGES_LOW:
+    table.fill_bfs(edge_group_index(solved_edges, 0), MOVE_COUNT,
+                   edge_group_next(0), thread_count);
+    break;
+  case TableKind::EDGES_HIGH:
+    table.fill_bfs(edge_group_index(solved_edges, EDGE_GROUP_SIZE), MOVE_COUNT,
+                   edge_group_next(EDGE_GROUP_SIZE), thread_count);
+    break;
+  default:
+    throw std::invalid_argument("Unknown table kind: " +
+                                std::to_string(static_cast<uint32_t>(kind)));
+  }
+}
+
+PruningTable build_table(TableKind kind, unsigned thread_count) {
+  PruningTable table(table_entry_count(kind));
+  fill_table(kind, table, thread_count);
+  return table;
+}
+
+uint64_t table_checksum(const PruningTable &table) {
+  // FNV-1a over 64 bit words, good enough to catch truncated or corrupted
+  // files and fast enough to run over gigabytes.
+  const uint64_t prime = 0x100000001b3;
+  uint64_t hash = 0xcbf29ce484222325;
+  auto data = table.data();
+  auto size = PruningTable::byte_size(table.size());
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * prime;
+  }
+  for (; i < size; i++) {
+    hash = (hash ^ data[i]) * prime;
+  }
+  return hash;
+}
+
+namespace {
+
+// Removes a partially written file unless it was renamed into place, so a
+// failed generation leaves nothing behind.
+struct PartialFile {
+  std::string path;
+  bool renamed = false;
+
+  ~PartialFile() {
+    if (!renamed) {
+      std::error_code ignored;
+      std::filesystem::remove(path, ignored);
+    }
+  }
+};
+
+} // namespace
+
+void generate_table_file(TableKind kind, const std::string &path,
+                         unsigned thread_count) {
+  auto size = table_entry_count(kind);
+  // Several processes may start generating the same table at once, each of
+  // them writes its own file and the last rename wins.
+  PartialFile partial{path + ".partial." +
+                      std::to_string(std::random_device()())};
+  {
+    auto mapping = MappedFile::create(
+        partial.path, sizeof(TableFileHeader) + PruningTable::byte_size(size));
+    auto header = reinterpret_cast<TableFileHeader *>(mapping.data());
+
+    PruningTable table(size, std::move(mapping), sizeof(TableFileHeader));
+    table.clear();
+    fill_table(kind, table, thread_count);
+
+    std::memset(header, 0, sizeof(TableFileHeader));
+    std::memcpy(header->magic, TableFileHeader::MAGIC, sizeof(header->magic));
+    header->format_version = TABLE_FORMAT_VERSION;
+    header->kind = static_cast<uint32_t>(kind);
+    header->entry_count = size;
+    header->checksum = table_checksum(table);
+    // Loading only checks the header, so the entries must be on disk
+    // before the file gets its final name.
+    table.sync();
+  }
+  std::filesystem::rename(partial.path, path);
+  partial.renamed = true;
+}
+
+static const TableFileHeader *check_header(TableKind kind,
+                                           const MappedFile &mapping) {
+  auto size = table_entry_count(kind);
+  if (mapping.size() !=
+      sizeof(TableFileHeader) + PruningTable::byte_size(size)) {
+    return nullptr;
+  }
+  auto header = reinterpret_cast<const TableFileHeader *>(mapping.data());
+  if (std::memcmp(header->magic, TableFileHeader::MAGIC,
+                  sizeof(header->magic)) != 0 ||
+      header->format_version != TABLE_FORMAT_VERSION ||
+      header->kind != static_cast<uint32_t>(kind) ||
+      header->entry_count != size) {
+    return nullptr;
+  }
+  return header;
+}
+
+std::optional<PruningTable> map_table_file(TableKind kind,
+                                           const std::string &path) {
+  auto mapping = MappedFile::open_read_only(path);
+  if (!mapping || check_header(kind, *mapping) == nullptr) {
+    return {};
+  }
+  return PruningTable(table_entry_count(kind), std::move(*mapping),
+                      sizeof(TableFileHeader));
+}
+
+bool verify_table_file(TableKind kind, const std::string &path) {
+  auto mapping = MappedFile::open_read_only(path);
+  if (!mapping) {
+    return false;
+  }
+  auto header = check_header(kind, *mapping);
+  if (header == nullptr) {
+    return false;
+  }
+  auto checksum = header->checksum;
+  PruningTable table(table_entry_count(kind), std::move(*mapping),
+                     sizeof(TableFileHeader));
+  return table_checksum(table) == checksum;
+}
+
+std::string table_directory() {
+  auto dir = std::getenv("RUBIKS_TABLE_DIR");
+  return dir != nullptr && *dir != '\0' ? dir : "./tables";
+}
+
+std::string table_path(TableKind kind) {
+  auto path = std::filesystem::path(table_directory()) /
+              (std::string(table_name(kind)) + ".prune");
+  return path.string();
+}
+
+PruningTable open_table(TableKind kind) {
+  auto path = table_path(kind);
+  if (auto table = map_table_file(kind, path)) {
+    return std::move(*table);
+  }
+
+  try {
+    std::filesystem::create_directories(table_directory());
+    generate_table_file(kind, path);
+  } catch (const std::exception &e) {
+    std::cerr << "Cannot cache " << table_name(kind) << " table (" << e.what()
+              << "), building it in memory!\n";
+    return build_table(kind);
+  }
+
+  if (auto table = map_table_file(kind, path)) {
+    return std::move(*table);
+  }
+  throw std::runtime_error("Generated table " + path + " cannot be mapped!");
+}
+
+} // namespace solver
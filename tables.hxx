@@ -0,0 +1,79 @@
+#ifndef TABLES_HXX
+#define TABLES_HXX
+#include "prune.hxx"
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace solver {
+
+// Every pruning table the solvers use. The values are part of the on-disk
+// format, only ever append new kinds without a format version bump.
+enum struct TableKind : uint32_t {
+  FLIPSLICE_TWIST,
+  SLICE_CORNERS,
+  SLICE_UD_EDGES,
+  CORNERS,
+  EDGES_LOW,
+  EDGES_HIGH,
+  COUNT
+};
+
+constexpr int TABLE_KIND_COUNT = static_cast<int>(TableKind::COUNT);
+
+// Bump whenever a coordinate, a table layout or the header changes so that
+// stale cached tables get rebuilt instead of silently misused.
+constexpr uint32_t TABLE_FORMAT_VERSION = 3;
+
+/* NOTE: Table files are the header followed by the nibble packed entries.
+ The header is checked on every load, the checksum only by
+ verify_table_file() since computing it would read in the whole table and
+ defeat the lazy paging of the mapping. */
+struct TableFileHeader {
+  static constexpr char MAGIC[8] = {'R', 'U', 'B', 'I', 'K', 'S', 'P', 'T'};
+
+  char magic[8];
+  uint32_t format_version;
+  uint32_t kind;
+  uint64_t entry_count;
+  uint64_t checksum;
+  uint8_t reserved[32];
+};
+static_assert(sizeof(TableFileHeader) == 64);
+
+// Short name used for file names and log messages, e.g. "slice_corners".
+const char *table_name(TableKind kind);
+size_t table_entry_count(TableKind kind);
+
+// Builds the table in memory with a breadth first search on thread_count
+// threads, 0 uses every core.
+PruningTable build_table(TableKind kind, unsigned thread_count = 0);
+
+// Table generation as a pipeline stage: the search writes straight into a
+// memory mapped file next to path which replaces path once it is complete,
+// so an interrupted run never leaves a truncated table behind.
+void generate_table_file(TableKind kind, const std::string &path,
+                         unsigned thread_count = 0);
+
+// Maps a table file read only. Returns nothing if the file is missing or its
+// header does not match the kind and the current format version.
+std::optional<PruningTable> map_table_file(TableKind kind,
+                                           const std::string &path);
+
+// Checks the header and the checksum of a table file.
+bool verify_table_file(TableKind kind, const std::string &path);
+
+uint64_t table_checksum(const PruningTable &table);
+
+// The cache directory for tables, $RUBIKS_TABLE_DIR or ./tables.
+std::string table_directory();
+std::string table_path(TableKind kind);
+
+// Maps the table from the cache directory, generating it there first if it
+// is missing or stale. Falls back to building it in memory when the cache
+// directory cannot be written.
+PruningTable open_table(TableKind kind);
+
+} // namespace solver
+
+#endif // TABLES_HXX
@@ -0,0 +1,61 @@
+#include "algorithm.hxx"
+#include "rubiks_cube.hxx"
+#include <iostream>
+#include <random>
+
+using cube::Algorithm;
+using cube::CubieCube;
+using cube::FaceletCube;
+using cube::Move;
+
+// A compiled algorithm must turn cubies, facelets and a RubiksCube from any
+// state the same as its moves one at a time, and its inverse must undo it.
+int main() {
+  std::mt19937_64 rng(2024);
+  auto cc = CubieCube::solved();
+  RubiksCube<3> rc;
+  rc.set_hashing(true);
+  for (int i = 0; i < 20; i++) {
+    auto m = static_cast<Move>(rng() % cube::MOVE_COUNT);
+    cc.apply(m);
+    rc.apply(m);
+  }
+  auto fc = FaceletCube::from_cubie(cc);
+
+  for (int length : {0, 1, 2, 7, 20, 100, 1000}) {
+    std::vector<Move> moves;
+    for (int i = 0; i < length; i++) {
+      moves.push_back(static_cast<Move>(rng() % cube::MOVE_COUNT));
+    }
+    Algorithm algorithm(moves);
+
+    auto cc_moves = cc, cc_compiled = cc;
+    auto fc_moves = fc, fc_compiled = fc;
+    auto rc_moves = rc, rc_compiled = rc;
+    for (auto m : moves) {
+      cc_moves.apply(m);
+      fc_moves.apply(m);
+      rc_moves.apply(m);
+    }
+    algorithm.apply(cc_compiled);
+    algorithm.apply(fc_compiled);
+    rc_compiled.apply(algorithm);
+    if (cc_compiled != cc_moves || fc_compiled != fc_moves ||
+        rc_compiled.state() != rc_moves.state() ||
+        rc_compiled.hash() != rc_moves.hash()) {
+      std::cerr << "Compiled " << length << " moves differ from the moves\n";
+      return 1;
+    }
+
+    algorithm.inverse().apply(cc_compiled);
+    algorithm.inverse().apply(fc_compiled);
+    auto parsed = Algorithm::parse(cube::to_string(moves));
+    if (cc_compiled != cc || fc_compiled != fc || !parsed ||
+        parsed->cubie() != algorithm.cubie()) {
+      std::cerr << "The inverse or the notation of " << length
+                << " moves is wrong\n";
+      return 1;
+    }
+  }
+  return 0;
+}
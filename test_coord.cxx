@@ -0,0 +1,95 @@
+#include "coord.hxx"
+#include "lehmer.hxx"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+using cube::CubieCube;
+using cube::Move;
+
+struct Coordinate {
+  const char *name;
+  int count;
+  int (*get)(const CubieCube &);
+  void (*set)(CubieCube &, int);
+  const std::vector<uint16_t> cube::MoveTables::*moves;
+};
+
+static const Coordinate COORDINATES[] = {
+    {"twist", cube::TWIST_COUNT, cube::get_twist, cube::set_twist,
+     &cube::MoveTables::twist},
+    {"flip", cube::FLIP_COUNT, cube::get_flip, cube::set_flip,
+     &cube::MoveTables::flip},
+    {"slice", cube::SLICE_SORTED_COUNT, cube::get_slice_sorted,
+     cube::set_slice_sorted, &cube::MoveTables::slice_sorted},
+    {"corners", cube::CORNERS_COUNT, cube::get_corners, cube::set_corners,
+     &cube::MoveTables::corners},
+    {"U/D edges", cube::UD_EDGES_COUNT, cube::get_ud_edges,
+     cube::set_ud_edges, &cube::MoveTables::ud_edges},
+};
+
+// The Lehmer ranks of all arrangements of k out of n elements must be
+// 0 .. n! / (n - k)! - 1 in lexicographic order.
+static bool check_lehmer(int k, int n) {
+  int count = 1;
+  for (int i = 0; i < k; i++) {
+    count *= n - i;
+  }
+  uint8_t previous[cube::LEHMER_MAX_ELEMENTS] = {};
+  for (int rank = 0; rank < count; rank++) {
+    uint8_t values[cube::LEHMER_MAX_ELEMENTS] = {};
+    cube::unrank_arrangement(rank, values, k, n);
+    if (cube::rank_arrangement(values, k, n) != rank ||
+        (rank > 0 && !std::lexicographical_compare(previous, previous + k,
+                                                   values, values + k))) {
+      std::cerr << "Rank " << rank << " of " << k << " out of " << n
+                << " elements does not read back\n";
+      return false;
+    }
+    std::copy(values, values + k, previous);
+  }
+  return true;
+}
+
+// Every coordinate must read back what was set and be zero when solved,
+// and the move tables must agree with turning the cube.
+int main() {
+  for (auto [k, n] : {std::pair{4, 4}, {8, 8}, {4, 12}, {7, 7}, {3, 10}}) {
+    if (!check_lehmer(k, n)) {
+      return 1;
+    }
+  }
+
+  const auto &mt = cube::MoveTables::instance();
+  std::mt19937_64 rng(2024);
+  for (const auto &coord : COORDINATES) {
+    if (coord.get(CubieCube::solved()) != 0) {
+      std::cerr << "The solved " << coord.name << " coordinate is not 0\n";
+      return 1;
+    }
+    for (int value = 0; value < coord.count; value++) {
+      auto cc = CubieCube::solved();
+      coord.set(cc, value);
+      if (coord.get(cc) != value) {
+        std::cerr << coord.name << " " << value << " does not read back\n";
+        return 1;
+      }
+      // The U/D edges are only defined for phase 2 moves.
+      auto m = static_cast<Move>(rng() % cube::MOVE_COUNT);
+      if (coord.moves == &cube::MoveTables::ud_edges &&
+          !cube::is_phase2_move(m)) {
+        continue;
+      }
+      cc.apply(m);
+      if ((mt.*coord.moves)[value * cube::MOVE_COUNT + static_cast<int>(m)] !=
+          coord.get(cc)) {
+        std::cerr << "The " << coord.name << " move table is wrong for "
+                  << value << " " << m << "\n";
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
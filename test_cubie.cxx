@@ -0,0 +1,100 @@
+#include "cube.hxx"
+#include <iostream>
+#include <random>
+#include <vector>
+
+using cube::CubieCube;
+using cube::Move;
+
+static std::vector<Move> random_moves(std::mt19937_64 &rng, int count) {
+  std::vector<Move> moves;
+  for (int i = 0; i < count; i++) {
+    moves.push_back(static_cast<Move>(rng() % cube::MOVE_COUNT));
+  }
+  return moves;
+}
+
+static bool fail(const char *what, const std::vector<Move> &moves) {
+  std::cerr << what << " after " << cube::to_string(moves) << "\n";
+  return false;
+}
+
+// Every move turned four times, and a sequence followed by its inverse,
+// gives the solved cube. Products must be associative and stay reachable,
+// and the notation must read back what it prints.
+static bool check_sequence(const std::vector<Move> &moves,
+                           const std::vector<Move> &other) {
+  auto a = CubieCube::solved();
+  a.apply(moves);
+  auto b = CubieCube::solved();
+  b.apply(other);
+  if (!a.is_valid()) {
+    return fail("Unreachable state", moves);
+  }
+
+  auto undone = a;
+  undone.multiply(a.inverse());
+  auto undone_left = a.inverse();
+  undone_left.multiply(a);
+  if (!undone.is_solved() || !undone_left.is_solved()) {
+    return fail("Inverse does not cancel", moves);
+  }
+
+  auto reversed = a;
+  for (auto it = moves.rbegin(); it != moves.rend(); ++it) {
+    reversed.apply(cube::inverse(*it));
+  }
+  if (!reversed.is_solved()) {
+    return fail("Inverse moves do not undo", moves);
+  }
+
+  // (a * b) * a == a * (b * a)
+  auto left = a;
+  left.multiply(b);
+  left.multiply(a);
+  auto right = b;
+  right.multiply(a);
+  auto product = a;
+  product.multiply(right);
+  if (left != product) {
+    return fail("Product is not associative", moves);
+  }
+
+  auto parsed = cube::parse_moves(cube::to_string(moves));
+  if (!parsed || *parsed != moves) {
+    return fail("Notation does not read back", moves);
+  }
+  return true;
+}
+
+int main() {
+  for (int m = 0; m < cube::MOVE_COUNT; m++) {
+    auto cc = CubieCube::solved();
+    for (int i = 0; i < 4; i++) {
+      cc.apply(static_cast<Move>(m));
+    }
+    if (!cc.is_solved()) {
+      std::cerr << static_cast<Move>(m) << " four times is not solved\n";
+      return 1;
+    }
+  }
+
+  std::mt19937_64 rng(2024);
+  for (int i = 0; i < 1000; i++) {
+    if (!check_sequence(random_moves(rng, 30), random_moves(rng, 30))) {
+      return 1;
+    }
+  }
+
+  auto twisted = CubieCube::solved();
+  twisted.set_corner(cube::URF, cube::URF, 1);
+  auto swapped = CubieCube::solved();
+  swapped.set_edge(cube::UR, cube::UF, 0);
+  swapped.set_edge(cube::UF, cube::UR, 0);
+  if (twisted.is_valid() || swapped.is_valid() ||
+      cube::parse_moves("R U X").has_value()) {
+    std::cerr << "Unreachable states or bad notation accepted\n";
+    return 1;
+  }
+  return 0;
+}
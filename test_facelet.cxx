@@ -0,0 +1,74 @@
+#include "facelet.hxx"
+#include <iostream>
+#include <random>
+#include <string>
+
+using cube::CubieCube;
+using cube::FaceletCube;
+using cube::Move;
+
+// Moves the stickers one by one, the way the kernels must.
+static FaceletCube permute(const FaceletCube &fc,
+                           const cube::FaceletPermutation &p) {
+  auto moved = fc;
+  for (int f = 0; f < cube::FACELET_COUNT; f++) {
+    moved.facelets[f] = fc.facelets[p.source[f]];
+  }
+  return moved;
+}
+
+// The move and layer kernels must move the stickers as the plain
+// permutations do and as the cubie model turns the cube, and parsing must
+// read back the stickers and reject strings that cannot be a cube.
+int main() {
+  std::mt19937_64 rng(2024);
+  auto cc = CubieCube::solved();
+  auto fc = FaceletCube::solved();
+  for (int i = 0; i < 2000; i++) {
+    auto m = static_cast<Move>(rng() % cube::MOVE_COUNT);
+    const auto &kernel = cube::MOVE_KERNELS[static_cast<int>(m)];
+    auto expected = permute(fc, kernel.permutation);
+    auto layer = fc;
+    layer.apply(cube::layer_kernel(cube::layer_move(m)));
+    cc.apply(m);
+    fc.apply(m);
+    if (fc != expected || fc != layer || fc != FaceletCube::from_cubie(cc)) {
+      std::cerr << "Kernel of " << m << " gives " << fc.to_string()
+                << " instead of " << expected.to_string() << "\n";
+      return 1;
+    }
+    for (int f = cube::FACELET_COUNT; f < cube::FACELET_PADDED_COUNT; f++) {
+      if (fc.facelets[f] != 0) {
+        std::cerr << "Kernel of " << m << " wrote into the padding\n";
+        return 1;
+      }
+    }
+    if (fc.to_cubie() != cc) {
+      std::cerr << fc.to_string() << " does not convert back\n";
+      return 1;
+    }
+
+    // Any six characters will do, the centers tell which face is which.
+    auto text = fc.to_string();
+    auto parsed = FaceletCube::parse(text);
+    for (auto &c : text) {
+      c = "abcdef"[std::string("URFDLB").find(c)];
+    }
+    if (parsed != fc || FaceletCube::parse(text) != fc) {
+      std::cerr << fc.to_string() << " does not parse back\n";
+      return 1;
+    }
+  }
+
+  auto solved = FaceletCube::solved().to_string();
+  auto twisted = solved;
+  std::swap(twisted[8], twisted[9]);
+  if (FaceletCube::parse(solved.substr(1)) ||
+      FaceletCube::parse(std::string(54, 'U')) ||
+      FaceletCube::parse(solved.substr(0, 53) + "X") ||
+      !FaceletCube::parse(twisted) || FaceletCube::parse(twisted)->to_cubie()) {
+    std::cerr << "Malformed or unreachable stickers accepted\n";
+    return 1;
+  }
+  return 0;
+}
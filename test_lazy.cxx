@@ -0,0 +1,125 @@
+#include "rubiks_cube.hxx"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+/* Runs of turns around one axis, so that the log merges turns of the same
+ layer and drops the ones that cancel, mixed with single turns of any
+ layer. Every run ends with the turns of the run undone in some order. */
+template <int N>
+static std::vector<cube::LayerMove> random_turns(std::mt19937_64 &rng,
+                                                 int count) {
+  std::vector<cube::LayerMove> turns;
+  auto random_turn = [&](int face) {
+    return cube::LayerMove{static_cast<cube::Face>(face),
+                           static_cast<uint16_t>(rng() % N),
+                           static_cast<uint8_t>(rng() % 3 + 1)};
+  };
+  while (static_cast<int>(turns.size()) < count) {
+    if (rng() % 2 == 0) {
+      turns.push_back(random_turn(rng() % 6));
+      continue;
+    }
+    int axis = rng() % 3;
+    std::vector<cube::LayerMove> run;
+    for (int i = rng() % 8; i >= 0; i--) {
+      run.push_back(random_turn(axis + 3 * (rng() % 2)));
+    }
+    turns.insert(turns.end(), run.begin(), run.end());
+    std::shuffle(run.begin(), run.end(), rng);
+    for (auto m : run) {
+      turns.push_back({m.face, m.depth, static_cast<uint8_t>(4 - m.power)});
+    }
+  }
+  return turns;
+}
+
+template <int N>
+static bool same_stickers(const RubiksCube<N> &a, const RubiksCube<N> &b) {
+  for (int i = 0; i < RubiksCube<N>::STICKER_COUNT; i++) {
+    if (a.sticker(i) != b.sticker(i)) {
+      return false;
+    }
+  }
+  if constexpr (N == 3) {
+    return a.hash() == b.hash() && a.state() == b.state();
+  } else {
+    return a.hash() == b.hash();
+  }
+}
+
+// A lazy cube must read the same as an eager one after every stretch of
+// turns, whatever the log merged or dropped, also while several threads
+// read it at once.
+template <int N> static bool check_lazy(int count) {
+  std::mt19937_64 rng(N);
+  RubiksCube<N> eager, lazy;
+  // One hash is kept up to date with the turns, the other one computed.
+  eager.set_hashing(true);
+  lazy.set_lazy(true);
+  auto turns = random_turns<N>(rng, count);
+  for (size_t i = 0; i < turns.size(); i++) {
+    eager.apply(turns[i]);
+    lazy.apply(turns[i]);
+    if (rng() % 1000 != 0 && i + 1 < turns.size()) {
+      continue;
+    }
+
+    const auto &view = lazy;
+    std::vector<std::thread> readers;
+    std::vector<char> same(4);
+    for (int t = 0; t < 4; t++) {
+      readers.emplace_back([&, t] {
+        same[t] = same_stickers(eager, view) &&
+                  view.is_solved() == eager.is_solved();
+      });
+    }
+    for (auto &reader : readers) {
+      reader.join();
+    }
+    if (lazy.pending_moves() != 0 || std::count(same.begin(), same.end(), 0)) {
+      std::cerr << N << "x" << N << " lazy cube differs after " << i + 1
+                << " turns\n";
+      return false;
+    }
+  }
+
+  // A turn and its inverse leave nothing in the log.
+  auto m = turns.back();
+  lazy.apply(m);
+  lazy.apply(
+      cube::LayerMove{m.face, m.depth, static_cast<uint8_t>(4 - m.power)});
+  if (lazy.pending_moves() != 0) {
+    std::cerr << N << "x" << N << " lazy cube did not cancel a turn\n";
+    return false;
+  }
+  return true;
+}
+
+// Turns nobody reads pile up until the log is applied on its own.
+static bool check_long_log() {
+  std::mt19937_64 rng(2024);
+  RubiksCube<3> eager, lazy;
+  eager.set_hashing(true);
+  lazy.set_lazy(true);
+  for (int i = 0; i < 100000; i++) {
+    auto m = static_cast<cube::Move>(rng() % cube::MOVE_COUNT);
+    eager.apply(m);
+    lazy.apply(m);
+  }
+  if (!same_stickers(eager, lazy)) {
+    std::cerr << "A long lazy log differs\n";
+    return false;
+  }
+  return true;
+}
+
+int main() {
+  return check_lazy<2>(20000) && check_lazy<3>(20000) &&
+                 check_lazy<4>(20000) && check_lazy<5>(20000) &&
+                 check_lazy<7>(20000) && check_long_log()
+             ? 0
+             : 1;
+}
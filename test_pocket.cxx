@@ -0,0 +1,67 @@
+#include "pocket.hxx"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using cube::CubieCube;
+using cube::Move;
+
+// Known number of 2x2x2 states at each distance in the half turn metric.
+static const std::vector<size_t> DISTANCE_COUNTS = {
+    1,      9,       54,      321,    1847, 9992, 50136, 227536,
+    870072, 1887748, 623800, 2644};
+
+static bool corners_solved(const CubieCube &cc) {
+  for (int i = 0; i < cube::CORNER_COUNT; i++) {
+    if (cc.corner_perm(i) != i || cc.corner_ori(i) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The search must find the known distance distribution, and the solutions
+// walked from the table must solve the corners in at most the scramble
+// length, and at most POCKET_MAX_DISTANCE moves.
+int main() {
+  const auto &pocket = solver::PocketSolver::instance();
+  if (pocket.distance_counts() != DISTANCE_COUNTS) {
+    std::cerr << "Distance counts:";
+    for (auto count : pocket.distance_counts()) {
+      std::cerr << " " << count;
+    }
+    std::cerr << "\n";
+    return 1;
+  }
+
+  std::mt19937_64 rng(2024);
+  for (int i = 0; i < 1000; i++) {
+    auto cc = CubieCube::solved();
+    int length = rng() % 25;
+    for (int k = 0; k < length; k++) {
+      cc.apply(static_cast<Move>(rng() % solver::POCKET_MOVE_COUNT));
+    }
+    auto solution = pocket.solve(cc);
+    auto solved = cc;
+    solved.apply(solution);
+    int moves = solution.size();
+    if (!corners_solved(solved) ||
+        moves > std::min(length, solver::POCKET_MAX_DISTANCE) ||
+        pocket.distance(cc) != moves) {
+      std::cerr << "Bad solution " << cube::to_string(solution) << "\n";
+      return 1;
+    }
+  }
+
+  auto moved = CubieCube::solved();
+  moved.apply(Move::L1);
+  try {
+    pocket.solve(moved);
+    std::cerr << "Solved corners with DBL out of place\n";
+    return 1;
+  } catch (const std::invalid_argument &) {
+  }
+  return 0;
+}
@@ -0,0 +1,68 @@
+#include "simplify.hxx"
+#include <iostream>
+#include <random>
+
+using cube::CubieCube;
+using cube::Move;
+
+static CubieCube state_of(const std::vector<Move> &moves) {
+  auto cc = CubieCube::solved();
+  cc.apply(moves);
+  return cc;
+}
+
+static std::vector<Move> parse(const char *text) {
+  return cube::parse_moves(text).value();
+}
+
+// Simplified and cancelled sequences must reach the same state as the moves
+// they came from and never be longer.
+static bool check(const std::vector<Move> &moves) {
+  for (auto simpler : {solver::cancel_moves(moves), solver::simplify(moves)}) {
+    if (state_of(simpler) != state_of(moves) || simpler.size() > moves.size()) {
+      std::cerr << cube::to_string(moves) << " became "
+                << cube::to_string(simpler) << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  std::mt19937_64 rng(2024);
+  for (int i = 0; i < 200; i++) {
+    // Random moves, with a stretch that is undone right after it.
+    std::vector<Move> moves;
+    for (int k = rng() % 30; k > 0; k--) {
+      moves.push_back(static_cast<Move>(rng() % cube::MOVE_COUNT));
+    }
+    auto undone = moves.size() - rng() % (moves.size() + 1);
+    for (auto k = moves.size(); k-- > undone;) {
+      moves.push_back(cube::inverse(moves[k]));
+    }
+    for (int k = rng() % 10; k > 0; k--) {
+      moves.push_back(static_cast<Move>(rng() % cube::MOVE_COUNT));
+    }
+    if (!check(moves)) {
+      return 1;
+    }
+  }
+
+  struct Known {
+    const char *moves;
+    size_t length;
+  };
+  for (auto [text, length] : {Known{"R R R", 1}, Known{"R L R'", 1},
+                              Known{"U D U' D'", 0}, Known{"F B F2 B' F", 0},
+                              Known{"R U R' U' U R U' R'", 0},
+                              Known{"R U R' U R U2 R'", 7}}) {
+    auto moves = parse(text);
+    auto simpler = solver::simplify(moves);
+    if (!check(moves) || simpler.size() != length) {
+      std::cerr << text << " became " << cube::to_string(simpler)
+                << " instead of " << length << " moves\n";
+      return 1;
+    }
+  }
+  return 0;
+}
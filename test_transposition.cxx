@@ -0,0 +1,55 @@
+#include "bidirectional.hxx"
+#include <iostream>
+#include <random>
+#include <vector>
+
+using Stats = solver::BidirectionalSolver::Stats;
+
+// Solves positions with and without the transposition table of the
+// bidirectional solver. The solutions must be equally short, and solving the
+// positions again must find the failed subtrees of the first time in the
+// table and expand fewer nodes.
+int main() {
+  solver::BidirectionalSolver with_table;
+  solver::BidirectionalSolver without_table(solver::DEFAULT_PERIMETER_DEPTH, 0);
+
+  std::mt19937_64 rng(2024);
+  std::vector<cube::CubieCube> positions;
+  for (int i = 0; i < 20; i++) {
+    auto cc = cube::CubieCube::solved();
+    for (int m = 0; m < 13; m++) {
+      cc.apply(static_cast<cube::Move>(rng() % cube::MOVE_COUNT));
+    }
+    positions.push_back(cc);
+  }
+
+  Stats plain, first, again;
+  for (const auto &cc : positions) {
+    Stats stats;
+    auto reference = without_table.solve(cc, solver::MAX_OPTIMAL_DEPTH, &stats);
+    plain.nodes += stats.nodes;
+    for (auto *total : {&first, &again}) {
+      auto solution = with_table.solve(cc, solver::MAX_OPTIMAL_DEPTH, &stats);
+      total->nodes += stats.nodes;
+      total->transposition_hits += stats.transposition_hits;
+      auto check = cc;
+      check.apply(*solution);
+      if (!check.is_solved() || solution->size() != reference->size()) {
+        std::cerr << cube::to_string(*solution) << " does not match "
+                  << cube::to_string(*reference) << "\n";
+        return 1;
+      }
+    }
+  }
+
+  std::cout << "Nodes without table: " << plain.nodes
+            << ", first solve: " << first.nodes << " ("
+            << first.transposition_hits << " hits), solved again: "
+            << again.nodes << " (" << again.transposition_hits << " hits)\n";
+  if (first.nodes > plain.nodes || again.transposition_hits == 0 ||
+      again.nodes >= first.nodes) {
+    std::cerr << "The transposition table did not save any nodes!\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,111 @@
+#include "thread_pool.hxx"
+#include <algorithm>
+
+// Which pool and worker the current thread belongs to, if any.
+static thread_local const ThreadPool *current_pool = nullptr;
+static thread_local unsigned current_worker = 0;
+
+ThreadPool::ThreadPool(unsigned thread_count) {
+  if (thread_count == 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (unsigned i = 0; i < thread_count; i++) {
+    m_queues.push_back(std::make_unique<Queue>());
+  }
+  for (unsigned i = 0; i < thread_count; i++) {
+    m_workers.emplace_back(&ThreadPool::run, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(m_mutex);
+    m_stopping = true;
+  }
+  m_task_available.notify_all();
+  for (auto &worker : m_workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+  unsigned index = current_pool == this
+                       ? current_worker
+                       : m_next_queue.fetch_add(1) % m_queues.size();
+  m_unfinished.fetch_add(1);
+  {
+    std::lock_guard lock(m_queues[index]->mutex);
+    m_queues[index]->tasks.push_back(std::move(task));
+  }
+  m_queued.fetch_add(1);
+  // A worker counts itself as sleeping before it checks m_queued, so either
+  // it sees the task or it is seen here. Taking the mutex makes sure it is
+  // waiting by the time it is notified.
+  if (m_sleeping.load() > 0) {
+    { std::lock_guard lock(m_mutex); }
+    m_task_available.notify_one();
+  }
+}
+
+void ThreadPool::wait() {
+  std::unique_lock lock(m_mutex);
+  m_all_done.wait(lock, [this] { return m_unfinished.load() == 0; });
+}
+
+bool ThreadPool::claim() {
+  size_t queued = m_queued.load();
+  while (queued > 0) {
+    if (m_queued.compare_exchange_weak(queued, queued - 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Only called after claiming one of the queued tasks, so there is always a
+// task left in some deque for this worker.
+std::function<void()> ThreadPool::take(unsigned index) {
+  for (unsigned i = 0;; i++) {
+    auto &queue = *m_queues[(index + i) % m_queues.size()];
+    std::lock_guard lock(queue.mutex);
+    if (queue.tasks.empty()) {
+      continue;
+    }
+    std::function<void()> task;
+    if (i % m_queues.size() == 0) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    } else {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    }
+    return task;
+  }
+}
+
+void ThreadPool::run(unsigned index) {
+  current_pool = this;
+  current_worker = index;
+
+  for (;;) {
+    if (!claim()) {
+      std::unique_lock lock(m_mutex);
+      m_sleeping.fetch_add(1);
+      m_task_available.wait(
+          lock, [this] { return m_queued.load() > 0 || m_stopping; });
+      m_sleeping.fetch_sub(1);
+      if (m_stopping && m_queued.load() == 0) {
+        return;
+      }
+      continue;
+    }
+
+    take(index)();
+
+    // The mutex orders the notification after a waiter's check of the count.
+    if (m_unfinished.fetch_sub(1) == 1) {
+      { std::lock_guard lock(m_mutex); }
+      m_all_done.notify_all();
+    }
+  }
+}
@@ -0,0 +1,67 @@
+#ifndef THREAD_POOL_HXX
+#define THREAD_POOL_HXX
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* NOTE: Every worker owns a deque of tasks. Tasks submitted from inside a
+ worker go to its own deque, the others are spread round robin. Workers run
+ their own tasks oldest first, so tasks start roughly in the order they were
+ submitted, and steal the newest task of another worker when they run dry so
+ the two ends of a deque rarely contend. */
+class ThreadPool {
+public:
+  // 0 starts one worker per core.
+  explicit ThreadPool(unsigned thread_count = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &other) = delete;
+  ThreadPool &operator=(const ThreadPool &other) = delete;
+
+  void submit(std::function<void()> task);
+
+  // Blocks until every submitted task has finished. Must not be called from
+  // inside a task.
+  void wait();
+
+  unsigned thread_count() const { return m_workers.size(); }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  void run(unsigned index);
+  std::function<void()> take(unsigned index);
+
+  std::vector<std::unique_ptr<Queue>> m_queues;
+  std::vector<std::thread> m_workers;
+  std::atomic<unsigned> m_next_queue = 0;
+
+  // Claims one of the queued tasks, false if there is none.
+  bool claim();
+
+  // Queued tasks are in some deque and not yet claimed by a worker,
+  // unfinished ones have not returned yet. The counters are atomic so that
+  // submitting and finishing tasks does not serialize on m_mutex, which is
+  // only taken to sleep and to wake sleepers up.
+  std::atomic<size_t> m_queued = 0;
+  std::atomic<size_t> m_unfinished = 0;
+  // Workers waiting for a task, submit() only notifies when there are any.
+  std::atomic<unsigned> m_sleeping = 0;
+
+  std::mutex m_mutex;
+  std::condition_variable m_task_available;
+  std::condition_variable m_all_done;
+  // Guarded by m_mutex.
+  bool m_stopping = false;
+};
+
+#endif // THREAD_POOL_HXX
@@ -0,0 +1,65 @@
+#include "transposition.hxx"
+#include <algorithm>
+#include <bit>
+
+namespace solver {
+
+// Set in the data of every used entry, so an empty one never matches.
+static constexpr uint64_t USED = uint64_t{1} << 40;
+
+static uint64_t pack(TranspositionTable::Entry entry) {
+  return entry.value | static_cast<uint64_t>(entry.depth) << 32 | USED;
+}
+
+TranspositionTable::TranspositionTable(size_t byte_size)
+    : m_mask(std::bit_floor(std::max<size_t>(byte_size / sizeof(Bucket), 1)) -
+             1) {
+  m_buckets = std::make_unique<Bucket[]>(m_mask + 1);
+}
+
+std::optional<TranspositionTable::Entry>
+TranspositionTable::probe(uint64_t key) const {
+  const auto &bucket = m_buckets[key & m_mask];
+  for (const auto &slot : bucket.slots) {
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((data & USED) && (check ^ data) == key) {
+      return Entry{static_cast<uint32_t>(data),
+                   static_cast<uint8_t>(data >> 32)};
+    }
+  }
+  return {};
+}
+
+void TranspositionTable::store(uint64_t key, Entry entry) {
+  auto &bucket = m_buckets[key & m_mask];
+  Slot *target = nullptr;
+  int shallowest = 256;
+  for (auto &slot : bucket.slots) {
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if (!(data & USED) || (check ^ data) == key) {
+      target = &slot;
+      break;
+    }
+    int depth = static_cast<uint8_t>(data >> 32);
+    if (depth < shallowest) {
+      shallowest = depth;
+      target = &slot;
+    }
+  }
+  uint64_t data = pack(entry);
+  target->data.store(data, std::memory_order_relaxed);
+  target->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear() {
+  for (size_t b = 0; b <= m_mask; b++) {
+    for (auto &slot : m_buckets[b].slots) {
+      slot.data.store(0, std::memory_order_relaxed);
+      slot.check.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+} // namespace solver
@@ -0,0 +1,54 @@
+#ifndef TRANSPOSITION_HXX
+#define TRANSPOSITION_HXX
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace solver {
+
+/* NOTE: A fixed size table of search results keyed by 64 bit hashes, shared
+ by any number of threads without locks. Four entries make a bucket of one
+ cache line. Every entry keeps its data and the key XORed with the data in
+ two atomics, a reader only takes the data when the two still XOR to its
+ key, so an entry torn by two threads writing at once reads as a miss
+ rather than as another state's result. A full bucket gives up the entry
+ with the least search behind it. */
+class TranspositionTable {
+public:
+  struct Entry {
+    uint32_t value;
+    // How much search backs the value, deeper entries are kept longer.
+    uint8_t depth;
+  };
+
+  static constexpr int BUCKET_SIZE = 4;
+
+  // Uses at most byte_size bytes, rounded down to a power of two buckets.
+  explicit TranspositionTable(size_t byte_size);
+
+  std::optional<Entry> probe(uint64_t key) const;
+  void store(uint64_t key, Entry entry);
+  void clear();
+
+  size_t capacity() const { return (m_mask + 1) * BUCKET_SIZE; }
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> check;
+    std::atomic<uint64_t> data;
+  };
+
+  struct alignas(64) Bucket {
+    std::array<Slot, BUCKET_SIZE> slots;
+  };
+
+  std::unique_ptr<Bucket[]> m_buckets;
+  size_t m_mask;
+};
+
+} // namespace solver
+
+#endif // TRANSPOSITION_HXX
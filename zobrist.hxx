@@ -0,0 +1,81 @@
+#ifndef ZOBRIST_HXX
+#define ZOBRIST_HXX
+#include "layer.hxx"
+#include <cstdint>
+#include <vector>
+
+namespace cube {
+
+/* NOTE: Zobrist hashing of the sticker model: a random key for every sticker
+ and color, the hash is the XOR of the keys of all stickers. A layer turn
+ only changes the keys of the stickers it moves, so the hash follows a turn
+ by XORing each of them out at the old place and in at the new one, walking
+ the same cycles that move the stickers. The keys are the same in every run
+ so hashes can be stored. */
+template <int N> const std::vector<uint64_t> &zobrist_keys() {
+  static const std::vector<uint64_t> keys = [] {
+    std::vector<uint64_t> keys(STICKER_COUNT<N> * 6);
+    uint64_t state = 0x2545f4914f6cdd1d ^ N;
+    for (auto &key : keys) {
+      // splitmix64
+      uint64_t z = (state += 0x9e3779b97f4a7c15);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+      key = z ^ (z >> 31);
+    }
+    return keys;
+  }();
+  return keys;
+}
+
+template <int N> uint64_t zobrist_hash(const uint8_t *stickers) {
+  const auto &keys = zobrist_keys<N>();
+  uint64_t hash = 0;
+  for (int i = 0; i < STICKER_COUNT<N>; i++) {
+    hash ^= keys[i * 6 + stickers[i]];
+  }
+  return hash;
+}
+
+namespace detail {
+
+template <typename Cycles>
+uint64_t cycle_delta(const uint8_t *stickers, const uint64_t *keys,
+                     const Cycles &cycles, int power) {
+  uint64_t delta = 0;
+  for (const auto &c : cycles) {
+    for (int k = 0; k < 4; k++) {
+      int color = stickers[c[k]];
+      delta ^= keys[c[k] * 6 + color] ^ keys[c[(k + power) % 4] * 6 + color];
+    }
+  }
+  return delta;
+}
+
+} // namespace detail
+
+// What a layer turn XORs into the hash, taken before the turn.
+template <int N>
+uint64_t zobrist_delta(const uint8_t *stickers, LayerMove m) {
+  const auto &cycles = layer_cycles<N>();
+  const auto *keys = zobrist_keys<N>().data();
+  int face = static_cast<int>(m.face);
+  uint64_t delta =
+      face < 3 ? detail::cycle_delta(stickers, keys,
+                                     cycles.strips[face][m.depth], m.power)
+               : detail::cycle_delta(stickers, keys,
+                                     cycles.strips[face - 3][N - 1 - m.depth],
+                                     4 - m.power);
+  if (m.depth == 0) {
+    delta ^= detail::cycle_delta(stickers, keys, cycles.faces[face], m.power);
+  }
+  if (m.depth == N - 1) {
+    delta ^= detail::cycle_delta(stickers, keys, cycles.faces[(face + 3) % 6],
+                                 4 - m.power);
+  }
+  return delta;
+}
+
+} // namespace cube
+
+#endif // ZOBRIST_HXX